@@ -0,0 +1,120 @@
+#include "action.hpp"
+#include <comp-ai.hpp>
+
+namespace ai
+{
+
+namespace
+{
+
+void applyAction(entt::registry& registry,
+                 entt::entity entity,
+                 const action::MoveTo& moveTo)
+{
+    auto* moveCtrl = registry.try_get<ecs::MoveCtrl>(entity);
+    if (!moveCtrl)
+    {
+        return;
+    }
+    moveCtrl->moveMode = ecs::MoveCtrl::MoveMode::MoveTo;
+    moveCtrl->spPos = moveTo.spPos;
+    moveCtrl->allowedPosError = moveTo.allowedPosError;
+    moveCtrl->allowedRotError = moveTo.allowedRotError;
+    moveCtrl->turnMode = ecs::MoveCtrl::TurnMode::Forward;
+    moveCtrl->faceDirData =
+        ecs::MoveCtrl::MCForwardData{moveTo.minFaceForwardDist};
+    if (moveTo.arrived)
+    {
+        moveCtrl->posReached = false;
+        moveCtrl->rotReached = false;
+        moveCtrl->moveMode = ecs::MoveCtrl::MoveMode::Brake;
+        moveCtrl->turnMode = ecs::MoveCtrl::TurnMode::Brake;
+    }
+}
+
+void applyAction(entt::registry& registry,
+                 entt::entity entity,
+                 const action::TurretTarget& turretTarget)
+{
+    if (auto* turret = registry.try_get<ecs::Turret>(entity))
+    {
+        turret->autoTarget = turretTarget.filter;
+    }
+}
+
+void applyAction(entt::registry& registry,
+                 entt::entity entity,
+                 const action::TurretAim& turretAim)
+{
+    if (auto* turret = registry.try_get<ecs::Turret>(entity))
+    {
+        turret->setAimMode(turretAim.mode);
+    }
+}
+
+void applyAction(entt::registry& registry,
+                 entt::entity entity,
+                 const action::TurretFire& turretFire)
+{
+    if (auto* turret = registry.try_get<ecs::Turret>(entity))
+    {
+        turret->fireMode = turretFire.mode;
+        turret->isFiring = turretFire.firing;
+    }
+}
+
+}  // namespace
+
+void ActionBuffer::apply(entt::registry& registry,
+                         TaskSystem& taskSystem,
+                         uint32_t frame)
+{
+    for (const auto& action : actions)
+    {
+        std::visit(
+            [&](const auto& data)
+            {
+                using T = std::decay_t<decltype(data)>;
+                if constexpr (std::is_same_v<T, action::PushTask>)
+                {
+                    pushToStack(
+                        registry, taskSystem, frame, action.entity, data);
+                }
+                else
+                {
+                    applyAction(registry, action.entity, data);
+                }
+            },
+            action.data);
+    }
+}
+
+void ActionBuffer::pushToStack(entt::registry& registry,
+                               TaskSystem& taskSystem,
+                               uint32_t frame,
+                               entt::entity entity,
+                               const action::PushTask& pushTask)
+{
+    auto* ai = registry.try_get<ecs::Ai>(entity);
+    if (!ai)
+    {
+        return;
+    }
+    const TaskStackHandle stackHandle(ai->stackHandle);
+    auto& task = tasks[pushTask.taskIdx];
+    switch (pushTask.placement)
+    {
+        case action::TaskPlacement::First:
+            taskSystem.addTaskFirst(stackHandle, std::move(task));
+            break;
+        case action::TaskPlacement::Last:
+            taskSystem.addTaskLast(stackHandle, std::move(task));
+            break;
+        case action::TaskPlacement::ReplaceAll:
+            taskSystem.addTaskReplaceAll(stackHandle, std::move(task));
+            break;
+    }
+    ai->nextRunFrame = frame + 1;
+}
+
+}  // namespace ai
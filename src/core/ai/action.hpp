@@ -0,0 +1,116 @@
+#ifndef ACTION_HPP
+#define ACTION_HPP
+
+#include <comp-phy.hpp>
+#include <comp-turret.hpp>
+#include <entt/entt.hpp>
+#include <memory_resource>
+#include <std-inc.hpp>
+#include <task-system.hpp>
+#include <world-def.hpp>
+
+namespace ai
+{
+namespace action
+{
+
+// Steer toward spPos. arrived brakes instead and consumes the reached flags.
+struct MoveTo
+{
+    def::SectorCoords spPos;
+    float allowedPosError;
+    float allowedRotError;
+    float minFaceForwardDist;
+    bool arrived;
+};
+
+struct TurretTarget
+{
+    ecs::Turret::TargetFilter filter;
+};
+
+struct TurretAim
+{
+    ecs::Turret::AimMode mode;
+};
+
+struct TurretFire
+{
+    ecs::Turret::FireMode mode;
+    bool firing;
+};
+
+enum class TaskPlacement : uint8_t
+{
+    First,
+    Last,
+    ReplaceAll,
+};
+
+// Adds a task to the stack of the entity and runs it next frame. The task
+// itself waits in the buffer, taskIdx refers to it.
+struct PushTask
+{
+    uint32_t taskIdx;
+    TaskPlacement placement;
+};
+
+using ActionData =
+    std::variant<MoveTo, TurretTarget, TurretAim, TurretFire, PushTask>;
+
+}  // namespace action
+
+struct Action
+{
+    entt::entity entity;
+    action::ActionData data;
+};
+
+// Component and task stack writes requested by tasks during the decide
+// phase. Tasks only read the registry, the buffer is applied after all due
+// stacks decided. Use the frame arena of the thread that fills the buffer.
+class ActionBuffer
+{
+  public:
+    ActionBuffer(std::pmr::memory_resource* resource)
+        : actions(resource), tasks(resource)
+    {
+    }
+
+    template <class T> void emit(entt::entity entity, const T& data)
+    {
+        actions.push_back({entity, data});
+    }
+    // Stacks of other entities may run in other decide chunks at the same
+    // time, so tasks for any stack, the own one included, go through here
+    void pushTask(entt::entity entity,
+                  taskdata::TaskData&& task,
+                  action::TaskPlacement placement)
+    {
+        emit(entity, action::PushTask{uint32_t(tasks.size()), placement});
+        tasks.push_back(std::move(task));
+    }
+    // Writes the actions in emission order, entities that lost the target
+    // component meanwhile are skipped. Moves the pushed tasks out.
+    void apply(entt::registry& registry,
+               TaskSystem& taskSystem,
+               uint32_t frame);
+    size_t size() const
+    {
+        return actions.size();
+    }
+
+  private:
+    void pushToStack(entt::registry& registry,
+                     TaskSystem& taskSystem,
+                     uint32_t frame,
+                     entt::entity entity,
+                     const action::PushTask& pushTask);
+
+    std::pmr::vector<Action> actions;
+    std::pmr::vector<taskdata::TaskData> tasks;
+};
+
+}  // namespace ai
+
+#endif
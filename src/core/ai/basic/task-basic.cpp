@@ -1,6 +1,8 @@
 #include "task-basic.hpp"
+#include <action.hpp>
 #include <world.hpp>
 #include <sector.hpp>
+#include <task-system.hpp>
 #include <comp-phy.hpp>
 
 namespace ai
@@ -8,28 +10,127 @@ namespace ai
 namespace taskdata
 {
 
-bool applyMoveToTarget(ecs::MoveCtrl* moveCtrl, const MoveToTarget& target)
+// Frames between route updates while travelling legs or waypoints
+constexpr uint32_t ROUTE_INTERVAL = 30;
+// Distance at which an in-sector waypoint counts as passed
+constexpr float WAYPOINT_REACH_DIST = 50.0f;
+
+bool decideMoveToTarget(TaskFunArgs* args,
+                        const ecs::MoveCtrl& moveCtrl,
+                        const MoveToTarget& target)
 {
-    moveCtrl->moveMode = ecs::MoveCtrl::MoveMode::MoveTo;
-    moveCtrl->spPos = target.spPos;
-    moveCtrl->allowedPosError = target.allowedPosError;
-    moveCtrl->allowedRotError = target.allowedRotError;
-    moveCtrl->turnMode = ecs::MoveCtrl::TurnMode::Forward;
-    moveCtrl->faceDirData =
-        ecs::MoveCtrl::MCForwardData{target.minFaceForwardDist};
+    const bool arrived = moveCtrl.posReached && moveCtrl.rotReached;
+    args->actions->emit(args->entity,
+                        action::MoveTo{target.spPos,
+                                       target.allowedPosError,
+                                       target.allowedRotError,
+                                       target.minFaceForwardDist,
+                                       arrived});
+    return arrived;
+}
 
-    if (moveCtrl->moveMode != ecs::MoveCtrl::MoveMode::Brake
-        && moveCtrl->posReached
-        && moveCtrl->turnMode != ecs::MoveCtrl::TurnMode::Brake
-        && moveCtrl->rotReached)
-    {
-        moveCtrl->posReached = false;
-        moveCtrl->rotReached = false;
-        moveCtrl->moveMode = ecs::MoveCtrl::MoveMode::Brake;
-        moveCtrl->turnMode = ecs::MoveCtrl::TurnMode::Brake;
-        return true;
-    }
-    return false;
+bool RouteToTarget::follow(TaskFunArgs* args,
+                           const MoveToTarget& target,
+                           const ecs::MoveCtrl& moveCtrl,
+                           const ecs::SectorId& sectorId,
+                           const ecs::Transform& transform,
+                           uint32_t& interval)
+{
+    if (planned && plannedFor != target.spPos)
+    {
+        planned = false;
+        inSectorPlanned = false;
+    }
+    plannedFor = target.spPos;
+    auto& routePlanner = args->ptrHandle->world->getRoutePlanner();
+    const def::SectorPos here = {sectorId.x, sectorId.y};
+    if (here != target.spPos.pos)
+    {
+        inSectorPlanned = false;
+        auto onRoute = [this, &here]()
+        {
+            for (size_t i = leg; route && i < route->sectors.size(); i++)
+            {
+                if (route->sectors[i] == here)
+                {
+                    leg = i;
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (!planned || !onRoute())
+        {
+            route = routePlanner.findRoute(here, target.spPos.pos);
+            leg = 0;
+            planned = true;
+        }
+        if (!route || route->sectors.size() < 2)
+        {
+            // No route through the sector graph, fly straight
+            return decideMoveToTarget(args, moveCtrl, target);
+        }
+        // Steer at the end of the straight run ahead, the ship only slows
+        // down where the route turns
+        const auto& sectors = route->sectors;
+        auto delta = [&sectors](size_t i)
+        {
+            return std::pair<int64_t, int64_t>(
+                int64_t(sectors[i + 1].x) - sectors[i].x,
+                int64_t(sectors[i + 1].y) - sectors[i].y);
+        };
+        size_t legEnd = leg + 1;
+        while (legEnd + 1 < sectors.size() && delta(legEnd) == delta(leg))
+        {
+            legEnd++;
+        }
+        interval = std::min(interval, ROUTE_INTERVAL);
+        if (legEnd + 1 == sectors.size())
+        {
+            decideMoveToTarget(args, moveCtrl, target);
+        }
+        else
+        {
+            decideMoveToTarget(
+                args,
+                moveCtrl,
+                {.spPos = {.pos = sectors[legEnd], .sectorPos = {0.0f, 0.0f}},
+                 .allowedPosError = target.allowedPosError,
+                 .allowedRotError = target.allowedRotError});
+        }
+        return false;
+    }
+
+    // Target sector reached, go around its stations. Another task of the
+    // stack may have planned since, then the waypoints are no longer ours.
+    auto* taskStack = args->taskStack;
+    if (!inSectorPlanned || !taskStack->ownsWaypoints(waypointPlan))
+    {
+        auto& waypoints = taskStack->beginWaypoints(waypointPlan);
+        args->sector->getNavGraph().plan(
+            transform.pos, target.spPos.sectorPos, waypoints);
+        waypoint = 0;
+        inSectorPlanned = true;
+    }
+    const auto waypoints = taskStack->getWaypoints(waypointPlan);
+    while (waypoint + 1 < waypoints.size()
+           && glm::length(waypoints[waypoint] - transform.pos)
+                  < WAYPOINT_REACH_DIST)
+    {
+        waypoint++;
+    }
+    if (waypoint + 1 < waypoints.size())
+    {
+        interval = std::min(interval, ROUTE_INTERVAL);
+        decideMoveToTarget(args,
+                           moveCtrl,
+                           {.spPos = {.pos = here,
+                                      .sectorPos = waypoints[waypoint]},
+                            .allowedPosError = WAYPOINT_REACH_DIST,
+                            .allowedRotError = target.allowedRotError});
+        return false;
+    }
+    return decideMoveToTarget(args, moveCtrl, target);
 }
 
 TaskFunResult Idle::function(TaskFunArgs* args)
@@ -39,10 +140,9 @@ TaskFunResult Idle::function(TaskFunArgs* args)
 
 TaskFunResult UniversePatrol::function(TaskFunArgs* args)
 {
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* transform = reg->try_get<ecs::Transform>(args->entity);
-    auto* sectorId = reg->try_get<ecs::SectorId>(args->entity);
-    auto* moveCtrl = reg->try_get<ecs::MoveCtrl>(args->entity);
+    const auto* transform = args->reg->try_get<ecs::Transform>(args->entity);
+    const auto* sectorId = args->reg->try_get<ecs::SectorId>(args->entity);
+    const auto* moveCtrl = args->reg->try_get<ecs::MoveCtrl>(args->entity);
     if (!transform || !sectorId || !moveCtrl)
     {
         SCHED_NEXT(DEFAULT_INTERVAL);
@@ -54,35 +154,42 @@ TaskFunResult UniversePatrol::function(TaskFunArgs* args)
         makeRandomPos(args);
         state.initialized = true;
     }
-    if (applyMoveToTarget(moveCtrl,
-                          {.spPos = state.randomPos,
-                           .allowedPosError = config.allowedPosError,
-                           .allowedRotError = config.allowedRotError}))
+    uint32_t interval = DEFAULT_INTERVAL;
+    if (state.route.follow(args,
+                           {.spPos = state.randomPos,
+                            .allowedPosError = config.allowedPosError,
+                            .allowedRotError = config.allowedRotError},
+                           *moveCtrl,
+                           *sectorId,
+                           *transform,
+                           interval))
     {
         makeRandomPos(args);
     }
-    SCHED_NEXT(DEFAULT_INTERVAL);
+    SCHED_NEXT(interval);
     return TaskFunResult::Continue;
 }
 
 void UniversePatrol::makeRandomPos(TaskFunArgs* args)
 {
     auto& worldShape = args->ptrHandle->world->getWorldShape();
+    // Streams per entity, the result does not depend on the order in which
+    // the stacks of the sector decide
+    auto rng = args->sector->getRng().fork(args->entityId.index);
+    const float halfSize = 0.5f * worldShape.sectorSize;
     state.randomPos.sectorPos =
         0.9f
-        * vec2(
-            (rand() % (int)worldShape.sectorSize) - worldShape.sectorSize / 2,
-            (rand() % (int)worldShape.sectorSize) - worldShape.sectorSize / 2);
-    state.randomPos.pos.x = (rand() % (int)worldShape.numSectorX);
-    state.randomPos.pos.y = (rand() % (int)worldShape.numSectorY);
+        * vec2(rng.uniform(-halfSize, halfSize),
+               rng.uniform(-halfSize, halfSize));
+    state.randomPos.pos.x = rng.below(worldShape.numSectorX);
+    state.randomPos.pos.y = rng.below(worldShape.numSectorY);
 }
 
 TaskFunResult SectorPatrol::function(TaskFunArgs* args)
 {
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* transform = reg->try_get<ecs::Transform>(args->entity);
-    auto* sectorId = reg->try_get<ecs::SectorId>(args->entity);
-    auto* moveCtrl = reg->try_get<ecs::MoveCtrl>(args->entity);
+    const auto* transform = args->reg->try_get<ecs::Transform>(args->entity);
+    const auto* sectorId = args->reg->try_get<ecs::SectorId>(args->entity);
+    const auto* moveCtrl = args->reg->try_get<ecs::MoveCtrl>(args->entity);
     if (!transform || !sectorId || !moveCtrl)
     {
         SCHED_NEXT(DEFAULT_INTERVAL);
@@ -94,8 +201,9 @@ TaskFunResult SectorPatrol::function(TaskFunArgs* args)
         makeRandomPos(args);
         state.initialized = true;
     }
-    if (applyMoveToTarget(
-            moveCtrl,
+    if (decideMoveToTarget(
+            args,
+            *moveCtrl,
             {.spPos = {.pos = {sectorId->x, sectorId->y},
                        .sectorPos = state.randomPos},
              .allowedPosError = config.allowedPosError,
@@ -110,11 +218,12 @@ TaskFunResult SectorPatrol::function(TaskFunArgs* args)
 void SectorPatrol::makeRandomPos(TaskFunArgs* args)
 {
     auto& worldShape = args->ptrHandle->world->getWorldShape();
+    auto rng = args->sector->getRng().fork(args->entityId.index);
+    const float halfSize = 0.5f * worldShape.sectorSize;
     state.randomPos =
         0.9f
-        * vec2(
-            (rand() % (int)worldShape.sectorSize) - worldShape.sectorSize / 2,
-            (rand() % (int)worldShape.sectorSize) - worldShape.sectorSize / 2);
+        * vec2(rng.uniform(-halfSize, halfSize),
+               rng.uniform(-halfSize, halfSize));
 }
 
 TaskFunResult Patrol::function(TaskFunArgs* args)
@@ -124,47 +233,55 @@ TaskFunResult Patrol::function(TaskFunArgs* args)
         SCHED_NEXT(DEFAULT_INTERVAL);
         return TaskFunResult::Done;
     }
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* transform = reg->try_get<ecs::Transform>(args->entity);
-    auto* sectorId = reg->try_get<ecs::SectorId>(args->entity);
-    auto* moveCtrl = reg->try_get<ecs::MoveCtrl>(args->entity);
+    const auto* transform = args->reg->try_get<ecs::Transform>(args->entity);
+    const auto* sectorId = args->reg->try_get<ecs::SectorId>(args->entity);
+    const auto* moveCtrl = args->reg->try_get<ecs::MoveCtrl>(args->entity);
     if (!transform || !sectorId || !moveCtrl)
     {
         SCHED_NEXT(DEFAULT_INTERVAL);
         return TaskFunResult::EcsCompMissing;
     }
     auto& wayPoint = config.wayPoints[state.currentWayPointIndex];
-    if (applyMoveToTarget(moveCtrl,
-                          {.spPos = wayPoint,
-                           .allowedPosError = config.allowedPosError,
-                           .allowedRotError = config.allowedRotError}))
+    uint32_t interval = DEFAULT_INTERVAL;
+    if (state.route.follow(args,
+                           {.spPos = wayPoint,
+                            .allowedPosError = config.allowedPosError,
+                            .allowedRotError = config.allowedRotError},
+                           *moveCtrl,
+                           *sectorId,
+                           *transform,
+                           interval))
     {
         state.currentWayPointIndex++;
     }
-    SCHED_NEXT(DEFAULT_INTERVAL);
+    SCHED_NEXT(interval);
     return TaskFunResult::Continue;
 }
 
 TaskFunResult Goto::function(TaskFunArgs* args)
 {
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* transform = reg->try_get<ecs::Transform>(args->entity);
-    auto* sectorId = reg->try_get<ecs::SectorId>(args->entity);
-    auto* moveCtrl = reg->try_get<ecs::MoveCtrl>(args->entity);
+    const auto* transform = args->reg->try_get<ecs::Transform>(args->entity);
+    const auto* sectorId = args->reg->try_get<ecs::SectorId>(args->entity);
+    const auto* moveCtrl = args->reg->try_get<ecs::MoveCtrl>(args->entity);
     if (!transform || !sectorId || !moveCtrl)
     {
         SCHED_NEXT(DEFAULT_INTERVAL);
         return TaskFunResult::EcsCompMissing;
     }
-    if (applyMoveToTarget(moveCtrl,
-                          {.spPos = config.target,
-                           .allowedPosError = config.allowedPosError,
-                           .allowedRotError = config.allowedRotError}))
+    uint32_t interval = DEFAULT_INTERVAL;
+    if (state.route.follow(args,
+                           {.spPos = config.target,
+                            .allowedPosError = config.allowedPosError,
+                            .allowedRotError = config.allowedRotError},
+                           *moveCtrl,
+                           *sectorId,
+                           *transform,
+                           interval))
     {
         SCHED_NEXT(DEFAULT_INTERVAL);
         return TaskFunResult::Done;
     }
-    SCHED_NEXT(DEFAULT_INTERVAL);
+    SCHED_NEXT(interval);
     return TaskFunResult::Continue;
 }
 
@@ -3,6 +3,7 @@
 
 #include <cmath>
 #include <comp-phy.hpp>
+#include <route-planner.hpp>
 #include <std-inc.hpp>
 #include <world-def.hpp>
 #include <task.hpp>
@@ -20,12 +21,40 @@ struct MoveToTarget
     float minFaceForwardDist = 10.0f;
 };
 
-// Drive toward spPos; returns true when pos/rot targets are reached.
-bool applyMoveToTarget(ecs::MoveCtrl* moveCtrl, const MoveToTarget& target);
+// Emit a drive toward spPos; returns true when pos/rot targets are reached,
+// the ship brakes then.
+bool decideMoveToTarget(TaskFunArgs* args,
+                        const ecs::MoveCtrl& moveCtrl,
+                        const MoveToTarget& target);
+
+// Follows the shared sector route toward a target, then the waypoints
+// around the stations of the target sector. Plans again when the target
+// changes or the ship left its route.
+struct RouteToTarget
+{
+    // Returns true once target is reached. Lowers interval while the ship
+    // travels the legs, so it does not stall at a leg end.
+    bool follow(TaskFunArgs* args,
+                const MoveToTarget& target,
+                const ecs::MoveCtrl& moveCtrl,
+                const ecs::SectorId& sectorId,
+                const ecs::Transform& transform,
+                uint32_t& interval);
+
+    world::RouteRef route;
+    def::SectorCoords plannedFor = {{0, 0}, {0.0f, 0.0f}};
+    // Plan id of the in-sector waypoints, they live in the task stack
+    uint32_t waypointPlan = 0;
+    uint16_t leg = 0;
+    uint16_t waypoint = 0;
+    bool planned = false;
+    bool inSectorPlanned = false;
+};
 
 struct Idle
 {
     TASK_HEADER("idle", 60);
+    static constexpr TaskPriority PRIORITY = TaskPriority::Background;
     TaskFunResult function(TaskFunArgs* args);
 };
 
@@ -44,6 +73,7 @@ struct UniversePatrol
     {
         def::SectorCoords randomPos = {0, 0};
         bool initialized = false;
+        RouteToTarget route;
     };
     Config config;
     State state;
@@ -83,6 +113,7 @@ struct Patrol
     struct State
     {
         uint16_t currentWayPointIndex = 0;
+        RouteToTarget route;
     };
     Config config;
     State state;
@@ -99,7 +130,12 @@ struct Goto
         float allowedPosError = 10.0f;
         float allowedRotError = M_PIf;
     };
+    struct State
+    {
+        RouteToTarget route;
+    };
     Config config;
+    State state;
 };
 
 struct DebugLog
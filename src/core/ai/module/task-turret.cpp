@@ -1,7 +1,7 @@
 #include "task-turret.hpp"
+#include <action.hpp>
 #include <comp-struct.hpp>
 #include <comp-turret.hpp>
-#include <mod-manager.hpp>
 #include <sector.hpp>
 
 namespace ai
@@ -24,137 +24,53 @@ TaskFunResult Turret::function(TaskFunArgs* args)
     }
 }
 
-bool Turret::findBestTarget(TaskFunArgs* args,
-                            BestTarget& bestTarget,
-                            ScoreFunction scoreFunction)
+TaskFunResult Turret::funNone(TaskFunArgs* args)
 {
-    if (!args->sector)
-    {
-        return false;
-    }
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* transform = reg->try_get<ecs::Transform>(args->entity);
-    auto* turret = reg->try_get<ecs::Turret>(args->entity);
-    auto* module = reg->try_get<ecs::Module>(args->entity);
-    if (!transform || !turret || !module)
-    {
-        return false;
-    }
-    auto* moduleData = args->ptrHandle->modManager->getModuleLib().getItem(
-        module->moduleHandle);
-    if (!moduleData)
+    // Hands the turret back idle, it stops firing and targeting
+    if (args->reg->all_of<ecs::Turret>(args->entity))
     {
-        return false;
+        args->actions->emit(
+            args->entity,
+            action::TurretTarget{ecs::Turret::TargetFilter::None});
+        args->actions->emit(args->entity,
+                            action::TurretAim{ecs::Turret::AimMode::None});
+        args->actions->emit(
+            args->entity,
+            action::TurretFire{ecs::Turret::FireMode::None, false});
     }
-    auto& turretData = std::get<gobj::mdata::Turret>(moduleData->data);
-    float range = turretData.range;
-
-    bool hit = false;
-    bestTarget.score = std::numeric_limits<float>::max();
-    args->sector->queryBroadphase(
-        {transform->pos - range, transform->pos + range},
-        [&, this](const world::BpUserData& data)
-        {
-            if (data.type == world::BpUserType::Ecs)
-            {
-                auto entity = data.data.ent;
-                if (!reg->valid(entity) || !reg->all_of<ecs::EntityId>(entity))
-                {
-                    return;
-                }
-                // todo: don't use transform pos, use nearest collision point
-                ScoreArgs scoreArgs = {
-                    entity,
-                    range,
-                    *transform,
-                    *turret,
-                    turretData,
-                };
-                float score = scoreFunction(scoreArgs);
-                if (score > 0.0f)
-                {
-                    if (score < bestTarget.score)
-                    {
-                        bestTarget.entityId = reg->get<ecs::EntityId>(entity);
-                        bestTarget.score = score;
-                    }
-                    hit = true;
-                }
-            }
-        });
-    return hit;
-}
-
-TaskFunResult Turret::funNone(TaskFunArgs* args)
-{
     return TaskFunResult::Done;
 }
 
 TaskFunResult Turret::funMine(TaskFunArgs* args)
 {
-    BestTarget bestTarget;
-    ScoreFunction scoreFunction = [args](ScoreArgs& scoreArgs) -> float
+    // Target selection runs in sysTurretTarget, batched per ship over the
+    // sector broadphase. The task only has to switch the turret over.
+    if (!args->reg->all_of<ecs::Turret>(args->entity))
     {
-        auto* reg = args->sector->getRegistry()->getRegistry();
-        auto* asteroid = reg->try_get<ecs::Asteroid>(scoreArgs.tgt);
-        if (!asteroid)
-        {
-            return -1.0f;
-        }
-        auto* trTarget = reg->try_get<ecs::Transform>(scoreArgs.tgt);
-        if (!trTarget)
-        {
-            return -1.0f;
-        }
-        float distance = glm::distance(scoreArgs.trSelf.pos, trTarget->pos);
-        if (distance > scoreArgs.maxRange)
-        {
-            return -1.0f;
-        }
-        return distance;
-    };
-    if (findBestTarget(args, bestTarget, scoreFunction))
-    {
-        auto* reg = args->sector->getRegistry()->getRegistry();
-        auto* turret = reg->try_get<ecs::Turret>(args->entity);
-        if (!turret)
-        {
-            LG_E("No turret component");
-            return TaskFunResult::Failed;
-        }
-        turret->fireMode = ecs::Turret::FireMode::AutoAngle;
-        turret->aimMode = ecs::Turret::AimMode::Entity;
-        turret->aimData = ecs::Turret::EntityData{bestTarget.entityId};
-
-        SCHED_NEXT(DEFAULT_INTERVAL);
-        return TaskFunResult::Continue;
-    }
-    else
-    {
-        auto* reg = args->sector->getRegistry()->getRegistry();
-        auto* turret = reg->try_get<ecs::Turret>(args->entity);
-        if (!turret)
-        {
-            LG_E("No turret component");
-            return TaskFunResult::Failed;
-        }
-        turret->setAimMode(ecs::Turret::AimMode::None);
-        turret->fireMode = ecs::Turret::FireMode::None;
-        SCHED_NEXT(DEFAULT_INTERVAL);
-        return TaskFunResult::Continue;
+        LG_E("No turret component");
+        return TaskFunResult::Failed;
     }
+    args->actions->emit(
+        args->entity,
+        action::TurretTarget{ecs::Turret::TargetFilter::Asteroids});
+    SCHED_NEXT(DEFAULT_INTERVAL * 10);
+    return TaskFunResult::Continue;
 }
 
 TaskFunResult Turret::funPlayer(TaskFunArgs* args)
 {
-    auto* reg = args->sector->getRegistry()->getRegistry();
-    auto* turret = reg->try_get<ecs::Turret>(args->entity);
-    if (!turret)
+    if (!args->reg->all_of<ecs::Turret>(args->entity))
     {
         LG_E("No turret component");
         return TaskFunResult::Failed;
     }
-    turret->setAimMode(ecs::Turret::AimMode::Player);
+    args->actions->emit(args->entity,
+                        action::TurretTarget{ecs::Turret::TargetFilter::None});
+    args->actions->emit(args->entity,
+                        action::TurretAim{ecs::Turret::AimMode::Player});
+    // Fire stays off until the player pulls the trigger
+    args->actions->emit(
+        args->entity, action::TurretFire{ecs::Turret::FireMode::Manual, false});
     SCHED_NEXT(DEFAULT_INTERVAL * 10);
     return TaskFunResult::Done;
 }
@@ -3,20 +3,6 @@
 
 #include <task.hpp>
 
-namespace ecs
-{
-struct Transform;
-struct Turret;
-}
-
-namespace gobj
-{
-namespace mdata
-{
-struct Turret;
-}
-}
-
 namespace ai
 {
 namespace taskdata
@@ -32,26 +18,9 @@ struct Turret
         NumModes,
     };
 
-    struct BestTarget
-    {
-        ecs::EntityId entityId;
-        float score;
-    };
-
     TASK_HEADER("turret", 60);
+    static constexpr TaskPriority PRIORITY = TaskPriority::Combat;
 
-    struct ScoreArgs
-    {
-        entt::entity tgt;
-        float maxRange;
-        ecs::Transform& trSelf;
-        ecs::Turret& turret;
-        gobj::mdata::Turret& turretData;
-    };
-    using ScoreFunction = std::function<float(ScoreArgs& scoreArgs)>;
-    bool findBestTarget(TaskFunArgs* args,
-                        BestTarget& bestTarget,
-                        ScoreFunction scoreFunction);
     TaskFunResult function(TaskFunArgs* args);
     TaskFunResult funNone(TaskFunArgs* args);
     TaskFunResult funPlayer(TaskFunArgs* args);
@@ -1,5 +1,6 @@
 #include <task-system.hpp>
 #include <memory>
+#include <utility>
 #include <magic_enum/magic_enum.hpp>
 
 namespace ai
@@ -12,8 +13,50 @@ TaskStack::TaskStack(const taskdata::TaskData& defaultTask)
 {
 }
 
+TaskStack::TaskStack(TaskStack&& other)
+    : defaultTask(std::move(other.defaultTask)), ring(std::move(other.ring)),
+      first(std::exchange(other.first, 0)),
+      numTasks(std::exchange(other.numTasks, 0)),
+      waypoints(std::move(other.waypoints)),
+      waypointPlan(std::exchange(other.waypointPlan, 0))
+{
+    other.ring.clear();
+}
+
+TaskStack& TaskStack::operator=(TaskStack&& other)
+{
+    if (this != &other)
+    {
+        defaultTask = std::move(other.defaultTask);
+        ring = std::move(other.ring);
+        first = std::exchange(other.first, 0);
+        numTasks = std::exchange(other.numTasks, 0);
+        waypoints = std::move(other.waypoints);
+        waypointPlan = std::exchange(other.waypointPlan, 0);
+        other.ring.clear();
+    }
+    return *this;
+}
+
 TaskStack::~TaskStack() {}
 
+TaskStack TaskStack::clone() const
+{
+    TaskStack stack(defaultTask);
+    if (numTasks > 0)
+    {
+        stack.ring.resize(ring.size());
+        for (uint32_t i = 0; i < numTasks; i++)
+        {
+            stack.ring[i] = ring[(first + i) & (ring.size() - 1)];
+        }
+        stack.numTasks = numTasks;
+    }
+    stack.waypoints = waypoints;
+    stack.waypointPlan = waypointPlan;
+    return stack;
+}
+
 void TaskStack::setDefaultTask(const taskdata::TaskData& defaultTask)
 {
     taskdata::TaskData tmp(defaultTask);
@@ -21,25 +64,91 @@ void TaskStack::setDefaultTask(const taskdata::TaskData& defaultTask)
     std::construct_at(&this->defaultTask, std::move(tmp));
 }
 
+void TaskStack::grow()
+{
+    vector<taskdata::TaskData> grown(
+        std::max<size_t>(kMinRingSize, ring.size() * 2));
+    for (uint32_t i = 0; i < numTasks; i++)
+    {
+        grown[i] = std::move(ring[(first + i) & (ring.size() - 1)]);
+    }
+    ring = std::move(grown);
+    first = 0;
+}
+
+taskdata::TaskData& TaskStack::pushTop()
+{
+    if (numTasks == ring.size())
+    {
+        grow();
+    }
+    numTasks++;
+    return ring[topIdx()];
+}
+
+taskdata::TaskData& TaskStack::pushBottom()
+{
+    if (numTasks == ring.size())
+    {
+        grow();
+    }
+    first = (first - 1) & (ring.size() - 1);
+    numTasks++;
+    return ring[first];
+}
+
+void TaskStack::popTop()
+{
+    // Idle holds nothing, the waypoints stay in the stack and the route
+    // stays in the planner cache
+    ring[topIdx()].emplace<taskdata::Idle>();
+    numTasks--;
+}
+
+void TaskStack::clearTasks()
+{
+    while (numTasks > 0)
+    {
+        popTop();
+    }
+    first = 0;
+}
+
 void TaskStack::addTaskFirst(const taskdata::TaskData& task)
 {
-    tasks.push_back(task);
+    pushTop() = task;
+}
+
+void TaskStack::addTaskFirst(taskdata::TaskData&& task)
+{
+    pushTop() = std::move(task);
 }
 
 void TaskStack::addTaskLast(const taskdata::TaskData& task)
 {
-    tasks.insert(tasks.begin(), task);
+    pushBottom() = task;
+}
+
+void TaskStack::addTaskLast(taskdata::TaskData&& task)
+{
+    pushBottom() = std::move(task);
 }
 
 void TaskStack::addTaskReplaceAll(const taskdata::TaskData& task)
 {
-    tasks.clear();
-    tasks.push_back(task);
+    clearTasks();
+    pushTop() = task;
+}
+
+void TaskStack::addTaskReplaceAll(taskdata::TaskData&& task)
+{
+    clearTasks();
+    pushTop() = std::move(task);
 }
 
 TaskFunResult TaskStack::runTask(TaskFunArgs* args)
 {
-    if (tasks.empty())
+    if (numTasks == 0)
     {
         if (std::holds_alternative<taskdata::Idle>(defaultTask))
         {
@@ -49,19 +158,28 @@ TaskFunResult TaskStack::runTask(TaskFunArgs* args)
         }
         else
         {
-            tasks.push_back(defaultTask);
+            pushTop() = defaultTask;
         }
     }
-    auto& task = tasks.back();
     auto result = std::visit(
-        [args](auto& taskData) { return taskData.function(args); }, task);
+        [args](auto& taskData) { return taskData.function(args); },
+        ring[topIdx()]);
     if (result != TaskFunResult::Continue)
     {
-        tasks.pop_back();
+        popTop();
     }
     return result;
 }
 
+TaskPriority TaskStack::getPriority() const
+{
+    const auto& task = numTasks == 0 ? defaultTask : ring[topIdx()];
+    return std::visit(
+        [](const auto& taskData)
+        { return taskPriority<std::decay_t<decltype(taskData)>>(); },
+        task);
+}
+
 TaskSystem::TaskSystem() {}
 
 TaskSystem::~TaskSystem() {}
@@ -69,8 +187,7 @@ TaskSystem::~TaskSystem() {}
 TaskStackHandle
 TaskSystem::createTaskStack(const taskdata::TaskData& defaultTask)
 {
-    TaskStack stack(defaultTask);
-    return taskStacks.addItem(stack);
+    return taskStacks.addItem(TaskStack(defaultTask));
 }
 
 TaskStack* TaskSystem::getTaskStack(TaskStackHandle handle)
@@ -90,7 +207,7 @@ TaskFunResult TaskSystem::runTask(TaskStackHandle stackHandle,
 }
 
 void TaskSystem::addTaskFirst(TaskStackHandle stackHandle,
-                         const taskdata::TaskData& task)
+                              taskdata::TaskData task)
 {
     auto* taskStack = getTaskStack(stackHandle);
     if (!taskStack)
@@ -98,11 +215,11 @@ void TaskSystem::addTaskFirst(TaskStackHandle stackHandle,
         LG_E("No task stack for handle: {}", stackHandle.toGenericHandle());
         return;
     }
-    taskStack->addTaskFirst(task);
+    taskStack->addTaskFirst(std::move(task));
 }
 
 void TaskSystem::addTaskLast(TaskStackHandle stackHandle,
-                             const taskdata::TaskData& task)
+                             taskdata::TaskData task)
 {
     auto* taskStack = getTaskStack(stackHandle);
     if (!taskStack)
@@ -110,11 +227,11 @@ void TaskSystem::addTaskLast(TaskStackHandle stackHandle,
         LG_E("No task stack for handle: {}", stackHandle.toGenericHandle());
         return;
     }
-    taskStack->addTaskLast(task);
+    taskStack->addTaskLast(std::move(task));
 }
 
 void TaskSystem::addTaskReplaceAll(TaskStackHandle stackHandle,
-                                   const taskdata::TaskData& task)
+                                   taskdata::TaskData task)
 {
     auto* taskStack = getTaskStack(stackHandle);
     if (!taskStack)
@@ -122,7 +239,7 @@ void TaskSystem::addTaskReplaceAll(TaskStackHandle stackHandle,
         LG_E("No task stack for handle: {}", stackHandle.toGenericHandle());
         return;
     }
-    taskStack->addTaskReplaceAll(task);
+    taskStack->addTaskReplaceAll(std::move(task));
 }
 
 TaskStackHandle TaskSystem::moveTaskStackTo(TaskStackHandle stackHandle,
@@ -142,12 +259,24 @@ TaskStackHandle TaskSystem::moveTaskStackTo(TaskStackHandle stackHandle,
         LG_E("No task stack for handle: {}", stackHandle.toGenericHandle());
         return TaskStackHandle::Invalid();
     }
-    TaskStack copiedStack = *taskStack;
-    const TaskStackHandle newHandle = targetSystem.taskStacks.addItem(copiedStack);
+    const TaskStackHandle newHandle =
+        targetSystem.taskStacks.addItem(std::move(*taskStack));
     taskStacks.removeItem(stackHandle);
     return newHandle;
 }
 
+TaskStackHandle TaskSystem::copyTaskStackTo(TaskStackHandle stackHandle,
+                                            TaskSystem& targetSystem)
+{
+    auto* taskStack = getTaskStack(stackHandle);
+    if (!taskStack)
+    {
+        LG_E("No task stack for handle: {}", stackHandle.toGenericHandle());
+        return TaskStackHandle::Invalid();
+    }
+    return targetSystem.taskStacks.addItem(taskStack->clone());
+}
+
 void TaskSystem::destroyTaskStack(TaskStackHandle stackHandle)
 {
     if (!stackHandle.isValid())
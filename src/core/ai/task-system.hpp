@@ -17,21 +17,86 @@ using TaskData = std::
     variant<Idle, UniversePatrol, SectorPatrol, Patrol, Goto, DebugLog, Turret>;
 }  // namespace taskdata
 
+// Pending tasks live in a ring buffer, the top of the ring runs next. Adding
+// at either end is O(1) and finished tasks leave their slot to the next one,
+// so queueing orders does not allocate once the ring has grown to the
+// longest queue seen. Stacks are move only, copies go through clone().
 class TaskStack
 {
   public:
     TaskStack(const taskdata::TaskData& defaultTask = taskdata::Idle());
+    TaskStack(TaskStack&& other);
+    TaskStack& operator=(TaskStack&& other);
+    TaskStack(const TaskStack&) = delete;
+    TaskStack& operator=(const TaskStack&) = delete;
     ~TaskStack();
 
+    TaskStack clone() const;
     TaskFunResult runTask(TaskFunArgs* args);
+    // Priority of the task the next runTask() executes
+    TaskPriority getPriority() const;
     void addTaskFirst(const taskdata::TaskData& task);
+    void addTaskFirst(taskdata::TaskData&& task);
     void addTaskLast(const taskdata::TaskData& task);
+    void addTaskLast(taskdata::TaskData&& task);
     void addTaskReplaceAll(const taskdata::TaskData& task);
+    void addTaskReplaceAll(taskdata::TaskData&& task);
     void setDefaultTask(const taskdata::TaskData& defaultTask);
+    // Construct the task directly in its ring slot
+    template <class T, class... Args> T& emplaceTaskFirst(Args&&... args)
+    {
+        return pushTop().template emplace<T>(std::forward<Args>(args)...);
+    }
+    template <class T, class... Args> T& emplaceTaskLast(Args&&... args)
+    {
+        return pushBottom().template emplace<T>(std::forward<Args>(args)...);
+    }
+    uint32_t getNumTasks() const
+    {
+        return numTasks;
+    }
+    // In-sector waypoints of the task that planned last. They belong to the
+    // stack and keep their capacity, so popping a routing task frees
+    // nothing. beginWaypoints() clears them and hands out a new plan id,
+    // a task whose id is stale has been interrupted and plans again.
+    vector<vec2>& beginWaypoints(uint32_t& planId)
+    {
+        waypoints.clear();
+        planId = ++waypointPlan;
+        return waypoints;
+    }
+    bool ownsWaypoints(uint32_t planId) const
+    {
+        return planId != 0 && planId == waypointPlan;
+    }
+    std::span<const vec2> getWaypoints(uint32_t planId) const
+    {
+        return ownsWaypoints(planId) ? std::span<const vec2>(waypoints)
+                                     : std::span<const vec2>();
+    }
 
   private:
+    static constexpr uint32_t kMinRingSize = 4;
+
+    taskdata::TaskData& pushTop();
+    taskdata::TaskData& pushBottom();
+    void popTop();
+    void clearTasks();
+    void grow();
+    uint32_t topIdx() const
+    {
+        return (first + numTasks - 1) & (ring.size() - 1);
+    }
+
     taskdata::TaskData defaultTask;
-    vector<taskdata::TaskData> tasks;
+    // Size is zero or a power of two, unused slots hold Idle
+    vector<taskdata::TaskData> ring;
+    // Slot of the task that runs last
+    uint32_t first = 0;
+    uint32_t numTasks = 0;
+    vector<vec2> waypoints;
+    // Id of the plan in waypoints, 0 is never handed out
+    uint32_t waypointPlan = 0;
 };
 using TaskStackHandle = typename con::FreeVec<TaskStack>::Handle;
 
@@ -46,14 +111,16 @@ class TaskSystem
 
     TaskStack* getTaskStack(TaskStackHandle handle);
     TaskFunResult runTask(TaskStackHandle stackHandle, TaskFunArgs* args);
-    void addTaskFirst(TaskStackHandle stackHandle,
-                      const taskdata::TaskData& task);
-    void addTaskLast(TaskStackHandle stackHandle,
-                     const taskdata::TaskData& task);
+    void addTaskFirst(TaskStackHandle stackHandle, taskdata::TaskData task);
+    void addTaskLast(TaskStackHandle stackHandle, taskdata::TaskData task);
     void addTaskReplaceAll(TaskStackHandle stackHandle,
-                           const taskdata::TaskData& task);
+                           taskdata::TaskData task);
+    // Hands the stack over without copying its tasks, stackHandle is invalid
+    // afterwards
     TaskStackHandle moveTaskStackTo(TaskStackHandle stackHandle,
                                     TaskSystem& targetSystem);
+    TaskStackHandle copyTaskStackTo(TaskStackHandle stackHandle,
+                                    TaskSystem& targetSystem);
     void destroyTaskStack(TaskStackHandle stackHandle);
 
   private:
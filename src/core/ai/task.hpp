@@ -20,6 +20,27 @@ class Sector;
 namespace ai
 {
 
+// Order in which due task stacks are run when the AI budget of a sector is
+// tight. Tasks declare a static PRIORITY member, Normal otherwise.
+enum class TaskPriority : uint8_t
+{
+    Background,
+    Normal,
+    Combat,
+};
+
+template <class T> constexpr TaskPriority taskPriority()
+{
+    if constexpr (requires { T::PRIORITY; })
+    {
+        return T::PRIORITY;
+    }
+    else
+    {
+        return TaskPriority::Normal;
+    }
+}
+
 enum class TaskFunResult
 {
     Done,
@@ -30,6 +51,12 @@ enum class TaskFunResult
     EcsCompMissing,
 };
 
+class ActionBuffer;
+class TaskStack;
+
+// Tasks run in the decide phase: they read components through reg and emit
+// their writes to actions. Only taskStack and the schedule of the own entity
+// are written directly.
 struct TaskFunArgs
 {
     ecs::EntityId entityId;
@@ -37,6 +64,9 @@ struct TaskFunArgs
     ecs::PtrHandle* ptrHandle;
     uint32_t* nextRunFrame;
     world::Sector* sector;
+    const entt::registry* reg;
+    ActionBuffer* actions;
+    TaskStack* taskStack;
 };
 
 typedef TaskFunResult (*TaskFunction)(TaskFunArgs* args);
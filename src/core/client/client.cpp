@@ -155,16 +155,16 @@ void Client::scheduleSend(const std::string& token)
                         if (udpClient)
                         {
                             bitsery::Serializer<OutputAdapter> cmdser(
-                                OutputAdapter(sendData.data));
+                                OutputAdapter(sendData.payload()));
                             cmdser.text1b(token, 16);
-                            udpClient->sendMessage(sendData.data);
+                            udpClient->sendMessage(sendData.takeMsg());
                         }
                     }
                     else if (sendData.sendType == net::SendType::TCP)
                     {
                         if (tcpClient)
                         {
-                            tcpClient->sendMessage(sendData.data);
+                            tcpClient->sendMessage(sendData.payload());
                         }
                     }
                 }
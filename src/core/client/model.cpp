@@ -1560,10 +1560,13 @@ void Model::setupDataModelConnecting()
 void Model::handleDestroyEntity(bitsery::Deserializer<InputAdapter>& cmddes,
                                 size_t dataEndPos)
 {
-    (void)dataEndPos;
-    ecs::EntityId entityId;
-    cmddes.object(entityId);
-    clientRegistry.destroyServerEntity(entityId);
+    // A list of ids, the server coalesces all destructions of a tick
+    while ((int)cmddes.adapter().currentReadPos() <= (int)(dataEndPos) - 6)
+    {
+        ecs::EntityId entityId;
+        cmddes.object(entityId);
+        clientRegistry.destroyServerEntity(entityId);
+    }
 }
 
 void Model::handleSendProjData(bitsery::Deserializer<InputAdapter>& cmddes,
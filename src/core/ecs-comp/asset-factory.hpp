@@ -3,6 +3,7 @@
 
 #include "entt/entity/fwd.hpp"
 #include <comp-phy.hpp>
+#include <span>
 #include <std-inc.hpp>
 
 namespace mod
@@ -30,6 +31,20 @@ class ComponentFactory
                                                entt::entity,
                                                entt::registry&,
                                                entt::entity)>;
+    // Copies the component of srcEntities[i] to dstEntities[i] for a whole
+    // batch, the storage of the component is looked up once per batch
+    using BulkCopierFunc =
+        std::function<void(const entt::registry&,
+                           std::span<const entt::entity>,
+                           entt::registry&,
+                           std::span<const entt::entity>)>;
+    // Stamps the component of a prototype entity onto all dstEntities with
+    // one range insert
+    using PrototypeInserterFunc =
+        std::function<void(const entt::registry&,
+                           entt::entity,
+                           entt::registry&,
+                           std::span<const entt::entity>)>;
     using DeserializeIntoRegistryFunc = std::function<
         void(Registry&, game_entity, bitsery::Deserializer<InputAdapter>&)>;
     using SerializeFromRegistryFunc =
@@ -46,6 +61,8 @@ class ComponentFactory
         string name;
         AssetLoaderFunc assetLoader;
         AssetCopierFunc assetCopier;
+        BulkCopierFunc bulkCopier;
+        PrototypeInserterFunc prototypeInserter;
         DeserializeIntoRegistryFunc deserializeIntoRegistry;
         SerializeFromRegistryFunc serializeFromRegistry;
         DestroyFunc destroy;
@@ -112,6 +129,59 @@ class ComponentFactory
                         }
                     }
                 },
+                [](const entt::registry& srcRegistry,
+                   std::span<const entt::entity> srcEntities,
+                   entt::registry& dstRegistry,
+                   std::span<const entt::entity> dstEntities)
+                {
+                    const auto* srcStorage = srcRegistry.storage<Component>();
+                    if (!srcStorage || srcStorage->empty())
+                    {
+                        return;
+                    }
+                    auto& dstStorage = dstRegistry.storage<Component>();
+                    for (size_t i = 0; i < srcEntities.size(); i++)
+                    {
+                        if (!srcStorage->contains(srcEntities[i]))
+                        {
+                            continue;
+                        }
+                        if constexpr (std::is_empty_v<Component>)
+                        {
+                            dstStorage.emplace(dstEntities[i]);
+                        }
+                        else
+                        {
+                            dstStorage.emplace(dstEntities[i],
+                                               srcStorage->get(srcEntities[i]));
+                        }
+                    }
+                },
+                [](const entt::registry& srcRegistry,
+                   entt::entity prototype,
+                   entt::registry& dstRegistry,
+                   std::span<const entt::entity> dstEntities)
+                {
+                    if constexpr (std::is_empty_v<Component>)
+                    {
+                        if (srcRegistry.all_of<Component>(prototype))
+                        {
+                            dstRegistry.insert<Component>(dstEntities.begin(),
+                                                          dstEntities.end());
+                        }
+                    }
+                    else
+                    {
+                        auto component =
+                            srcRegistry.try_get<Component>(prototype);
+                        if (component)
+                        {
+                            dstRegistry.insert<Component>(dstEntities.begin(),
+                                                          dstEntities.end(),
+                                                          *component);
+                        }
+                    }
+                },
                 [name](Registry& registry,
                        game_entity entity,
                        bitsery::Deserializer<InputAdapter>& s)
@@ -150,6 +220,12 @@ class ComponentFactory
                     }
                 },
                 destroyFunc));
+        const entt::id_type storageId = entt::type_hash<Component>::value();
+        storageHelpers[storageId] = &componentHelpers[hash];
+        if (destroyFunc)
+        {
+            destroyHooks.push_back({storageId, destroyFunc});
+        }
     }
 
     const std::unordered_map<uint32_t, ComponentHelper>&
@@ -158,8 +234,29 @@ class ComponentFactory
         return componentHelpers;
     }
 
+    // Helper of the component stored in the registry pool with the given
+    // id, nullptr for pools that are not managed by the factory
+    const ComponentHelper* getHelperByStorage(entt::id_type storageId) const
+    {
+        auto it = storageHelpers.find(storageId);
+        return it != storageHelpers.end() ? it->second : nullptr;
+    }
+
+    struct DestroyHook
+    {
+        entt::id_type storageId;
+        DestroyFunc destroy;
+    };
+    // Only the components that registered a destroy function
+    const std::vector<DestroyHook>& getDestroyHooks() const
+    {
+        return destroyHooks;
+    }
+
   private:
     std::unordered_map<uint32_t, ComponentHelper> componentHelpers;
+    std::unordered_map<entt::id_type, const ComponentHelper*> storageHelpers;
+    std::vector<DestroyHook> destroyHooks;
 };
 
 struct AssetMapItem
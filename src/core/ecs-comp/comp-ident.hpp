@@ -45,6 +45,16 @@ struct EntityId
     }
 };
 
+// Sector local handle cached next to an EntityId reference, resolved and
+// validated by SectorRegistry::resolve. Never serialized, the entity is only
+// meaningful in the registry of sectorId and the id acts as its epoch: after
+// the owner of the reference migrated the handle is refreshed once.
+struct LocalRef
+{
+    entt::entity entity = entt::null;
+    uint32_t sectorId = 0xFFFFFFFF;
+};
+
 struct EntityIdHash
 {
     std::size_t operator()(ecs::EntityId const& id) const noexcept
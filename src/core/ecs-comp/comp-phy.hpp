@@ -7,6 +7,7 @@
 #include <climits>
 #include <cmath>
 #include <entt/entt.hpp>
+#include <frame-arena.hpp>
 #include <lib-collider.hpp>
 #include <magic_enum/magic_enum.hpp>
 #include <optional>
@@ -149,6 +150,8 @@ struct Collider
     GenericHandle colliderHandle;
     EntityId exceptEntity;
     CollisionLayer colliderType;
+    // Not serialized
+    LocalRef exceptRef;
 
     const gobj::Collider*
     getColliderDef(con::ItemLib<gobj::Collider>* colliderLib) const
@@ -271,10 +274,9 @@ inline std::optional<Contact> collideCollidersWorld(const Collider& c1,
         return std::nullopt;
     }
 
-    thread_local std::vector<vec2> w1;
-    thread_local std::vector<vec2> w2;
-    w1.resize(n1);
-    w2.resize(n2);
+    auto* arena = &con::alloc::FrameArena::local();
+    std::pmr::vector<vec2> w1(n1, arena);
+    std::pmr::vector<vec2> w2(n2, arena);
 
     for (size_t i = 0; i < n1; ++i)
     {
@@ -673,6 +675,12 @@ struct MoveCtrl
     std::variant<MCForwardData, MCTargetPointData> faceDirData =
         MCForwardData{10.0f};
 
+    // Server side only, not serialized. World space velocity the MoveTo
+    // controller steers for this tick, sysAvoidance bends it around
+    // neighbours before the thrust is applied.
+    vec2 desiredVel = vec2(0.0f);
+    bool desiredVelActive = false;
+
     static void fromYaml(entt::registry& registry,
                          entt::entity entity,
                          const YAML::Node& node,
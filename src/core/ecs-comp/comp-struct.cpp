@@ -6,11 +6,11 @@
 #include <lib-asteroid.hpp>
 #include <lib-item.hpp>
 #include <mod-manager.hpp>
-#include <random>
 #include <sector.hpp>
 #ifdef SERVER
 #include <objb-recipes.hpp>
 #include <comp-phy.hpp>
+#include <def-cache.hpp>
 #endif
 
 namespace ecs
@@ -22,7 +22,8 @@ namespace
 {
 
 gobj::ItemHandle
-pickCompositionItem(const gobj::AsteroidComposition& composition)
+pickCompositionItem(const gobj::AsteroidComposition& composition,
+                    con::Rng& rng)
 {
     float totalWeight = 0.0f;
     for (const auto& [handle, fraction] : composition)
@@ -37,9 +38,7 @@ pickCompositionItem(const gobj::AsteroidComposition& composition)
         return gobj::ItemHandle::Invalid();
     }
 
-    thread_local std::mt19937 gen{std::random_device{}()};
-    std::uniform_real_distribution<float> dist(0.0f, totalWeight);
-    const float pick = dist(gen);
+    const float pick = rng.uniform(0.0f, totalWeight);
 
     float cumulative = 0.0f;
     for (const auto& [handle, fraction] : composition)
@@ -60,14 +59,14 @@ pickCompositionItem(const gobj::AsteroidComposition& composition)
 }  // namespace
 
 void Asteroid::damage(PtrHandle* ptrHandle,
+                      con::Rng& rng,
                       float dmg,
-                      std::function<void(gobj::ItemHandle handle,
-                                         uint32_t quantity)> harvestCallback)
+                      con::FunctionRef<void(gobj::ItemHandle handle,
+                                            uint32_t quantity)> harvestCallback)
 {
     volume -= dmg;
-    gobj::Asteroid* asteroidData =
-        ptrHandle->modManager->getAsteroidLib().getItem(
-            gobj::AsteroidHandle(asteroidHandle));
+    const gobj::Asteroid* asteroidData =
+        ptrHandle->defCache->getAsteroid(asteroidHandle);
     if (!asteroidData)
     {
         return;
@@ -82,7 +81,7 @@ void Asteroid::damage(PtrHandle* ptrHandle,
             while (harvestProgress >= 10.0f)
             {
                 const gobj::ItemHandle itemHandle =
-                    pickCompositionItem(fragment.composition);
+                    pickCompositionItem(fragment.composition, rng);
                 if (itemHandle.isValid())
                 {
                     harvestCallback(itemHandle, 10);
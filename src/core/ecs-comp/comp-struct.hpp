@@ -3,8 +3,10 @@
 
 #include "comp-ident.hpp"
 #include "std-inc.hpp"
+#include <function-ref.hpp>
 #include <lib-modules.hpp>
 #include <magic_enum/magic_enum.hpp>
+#include <rng.hpp>
 
 namespace gobj
 {
@@ -34,6 +36,8 @@ struct ModuleRef
     EntityId entityId;
     gobj::ModuleType slotType;
     gobj::ModuleSlotType moduleSlotType;
+    // Not serialized
+    LocalRef localRef;
 };
 
 #define SER_MODULE_REF                                                         \
@@ -89,6 +93,8 @@ struct Module
 
     GenericHandle moduleHandle;
     EntityId parent;
+    // Not serialized
+    LocalRef parentRef;
 };
 
 #define SER_MODULE                                                             \
@@ -157,9 +163,10 @@ struct Asteroid
 
 #ifdef SERVER
     void damage(PtrHandle* ptrHandle,
+                con::Rng& rng,
                 float damage,
-                std::function<void(gobj::ItemHandle handle, uint32_t quantity)>
-                    harvestCallback);
+                con::FunctionRef<void(gobj::ItemHandle handle,
+                                      uint32_t quantity)> harvestCallback);
     void damageAndMine(PtrHandle* ptrHandle,
                        world::Sector* sector,
                        float dmg,
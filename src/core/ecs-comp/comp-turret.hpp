@@ -31,6 +31,14 @@ struct Turret
         AutoAngle,
         NumFireModes,
     };
+    // What sysTurretTarget looks for when the turret targets by itself
+    enum class TargetFilter : uint8_t
+    {
+        None,
+        Asteroids,
+        Ships,
+        NumTargetFilters,
+    };
 
     struct AngleData
     {
@@ -89,6 +97,11 @@ struct Turret
     TurretData data = ProjectileData{};
     float currentAngle = 0.0f;
     bool isFiring = false;
+    // Server side only, not serialized. With a filter set sysTurretTarget
+    // switches the turret to AimMode::Entity on its retarget cadence.
+    TargetFilter autoTarget = TargetFilter::None;
+    // Sector local handle of the EntityId in aimData
+    LocalRef target;
 };
 
 
@@ -48,6 +48,7 @@ class World;
 namespace mod
 {
 class ModManager;
+class DefCache;
 }
 
 namespace ecs
@@ -73,11 +74,23 @@ struct PtrHandle
     float angDrag;
     float linDrag;
     float minFaceTargetDist;
+    // Look ahead of the local avoidance in seconds, 0 (the default)
+    // disables it
+    float avoidHorizon;
+    // Integrate the TransformCache rotation without per tick cos / sin
+    bool complexRot;
     float miningRate;
     float itemLifetime;
+    // Seed of the per sector random streams, see world::Sector::getRng()
+    uint32_t rngSeed;
+    // Time a sector may spend on AI task stacks per tick
+    uint32_t aiBudgetU;
+    // Frames a due task stack waits per priority level it is raised by
+    uint32_t aiAgingFrames;
     ai::TaskSystem* taskSystem;
     ecs::CollisionLayerMat* collisionLayerMat;
     ecs::AssetFactory* assetFactory;
+    mod::DefCache* defCache;
 #elif CLIENT
     sphyc::Client* client;
 #endif
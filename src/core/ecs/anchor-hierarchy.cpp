@@ -0,0 +1,117 @@
+#include "anchor-hierarchy.hpp"
+#include <comp-phy.hpp>
+#include <logging.hpp>
+#include <registry-mapping.hpp>
+#include <world-def.hpp>
+
+namespace ecs
+{
+
+void AnchorHierarchy::connect(entt::registry& registry)
+{
+    registry.on_construct<AnchorFixed>()
+        .connect<&AnchorHierarchy::onAnchorChanged>(*this);
+    registry.on_update<AnchorFixed>()
+        .connect<&AnchorHierarchy::onAnchorChanged>(*this);
+    registry.on_destroy<AnchorFixed>()
+        .connect<&AnchorHierarchy::onAnchorChanged>(*this);
+    dirty = true;
+}
+
+void AnchorHierarchy::onAnchorChanged(entt::registry& registry,
+                                      entt::entity entity)
+{
+    dirty = true;
+}
+
+void AnchorHierarchy::onEntitiesArrived(std::span<const EntityId> entityIds)
+{
+    if (dirty)
+    {
+        return;
+    }
+    for (const auto& child : detached)
+    {
+        if (std::find(entityIds.begin(), entityIds.end(), child.parent)
+            != entityIds.end())
+        {
+            dirty = true;
+            return;
+        }
+    }
+}
+
+void AnchorHierarchy::refresh(entt::registry& registry,
+                              RegistryMapping& registryMapping,
+                              uint32_t sectorId)
+{
+    if (!dirty)
+    {
+        // Parents do not carry an AnchorFixed themselves, a destroyed or
+        // migrated parent only shows up as an invalid entity
+        for (const auto& parent : parents)
+        {
+            if (!registry.valid(parent.entity))
+            {
+                dirty = true;
+                break;
+            }
+        }
+    }
+    if (dirty)
+    {
+        rebuild(registry, registryMapping, sectorId);
+    }
+}
+
+void AnchorHierarchy::rebuild(entt::registry& registry,
+                              RegistryMapping& registryMapping,
+                              uint32_t sectorId)
+{
+    parents.clear();
+    children.clear();
+    detached.clear();
+    links.clear();
+
+    for (auto [entity, anchorFixed] :
+         registry.view<AnchorFixed, EntityId, Transform, SectorId>().each())
+    {
+        const EntMapSlot* slot = registryMapping.getEntity(anchorFixed.ref);
+        if (!slot)
+        {
+            detached.push_back(
+                {entity, anchorFixed.ref, world::INVALID_SECTOR_ID});
+        }
+        else if (slot->sectorId != sectorId || !registry.valid(slot->entity))
+        {
+            detached.push_back({entity, anchorFixed.ref, slot->sectorId});
+        }
+        else if (!registry.all_of<Transform, TransformCache, SectorId>(
+                     slot->entity))
+        {
+            LG_W("AnchorFixed parent {} has no pose", anchorFixed.ref);
+        }
+        else
+        {
+            links.emplace_back(slot->entity, entity);
+        }
+    }
+
+    // Group the children by parent, sorting by entity also keeps the child
+    // spans in storage friendly order
+    std::sort(links.begin(), links.end());
+    children.reserve(links.size());
+    for (const auto& [parent, child] : links)
+    {
+        if (parents.empty() || parents.back().entity != parent)
+        {
+            parents.push_back(
+                {parent, static_cast<uint32_t>(children.size()), 0});
+        }
+        children.push_back(child);
+        parents.back().numChildren++;
+    }
+    dirty = false;
+}
+
+}  // namespace ecs
@@ -0,0 +1,82 @@
+#ifndef ANCHOR_HIERARCHY_HPP
+#define ANCHOR_HIERARCHY_HPP
+
+#include <comp-ident.hpp>
+#include <entt/entt.hpp>
+#include <span>
+#include <std-inc.hpp>
+
+namespace ecs
+{
+
+class RegistryMapping;
+
+// Flattened parent -> children view of the AnchorFixed links of one sector
+// registry. The children of a parent are stored back to back and resolved to
+// entities of this registry, so propagating the parent poses is one linear
+// pass without global mapping lookups. The view is only rebuilt when an
+// AnchorFixed is added, replaced or removed, or when a parent went stale.
+class AnchorHierarchy
+{
+  public:
+    struct Parent
+    {
+        entt::entity entity;
+        uint32_t firstChild;
+        uint32_t numChildren;
+    };
+    // Child whose parent is not part of this registry
+    struct Detached
+    {
+        entt::entity entity;
+        EntityId parent;
+        // world::INVALID_SECTOR_ID if the parent does not exist anymore
+        uint32_t parentSectorId;
+    };
+
+    // Hooks the AnchorFixed signals of registry to the dirty flag
+    void connect(entt::registry& registry);
+    void invalidate()
+    {
+        dirty = true;
+    }
+    // Parents carry no AnchorFixed, so a parent migrating into the sector
+    // raises no signal. Marks the view dirty if one of entityIds is the
+    // parent of a detached child.
+    void onEntitiesArrived(std::span<const EntityId> entityIds);
+    // Rebuilds the view if it is dirty or a parent entity was destroyed
+    void refresh(entt::registry& registry,
+                 RegistryMapping& registryMapping,
+                 uint32_t sectorId);
+
+    std::span<const Parent> getParents() const
+    {
+        return parents;
+    }
+    std::span<const entt::entity> getChildren(const Parent& parent) const
+    {
+        return std::span<const entt::entity>(children).subspan(
+            parent.firstChild, parent.numChildren);
+    }
+    std::span<const Detached> getDetached() const
+    {
+        return detached;
+    }
+
+  private:
+    void onAnchorChanged(entt::registry& registry, entt::entity entity);
+    void rebuild(entt::registry& registry,
+                 RegistryMapping& registryMapping,
+                 uint32_t sectorId);
+
+    bool dirty = true;
+    vector<Parent> parents;
+    vector<entt::entity> children;
+    vector<Detached> detached;
+    // (parent, child) pairs, kept to reuse the allocation between rebuilds
+    vector<std::pair<entt::entity, entt::entity>> links;
+};
+
+}  // namespace ecs
+
+#endif  // ANCHOR_HIERARCHY_HPP
@@ -32,6 +32,34 @@ EntityId RegistryMapping::registerEntity(uint32_t sectorId, entt::entity entity)
     return entityId;
 }
 
+void RegistryMapping::registerEntities(uint32_t sectorId,
+                                       std::span<const entt::entity> entities,
+                                       std::span<EntityId> entityIds)
+{
+    const size_t count = entities.size();
+    const size_t reused = std::min(count, idMapFreeSlots.size());
+    const size_t firstNew = idMap.size();
+    idMap.resize(firstNew + count - reused);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t index;
+        if (i < reused)
+        {
+            index = idMapFreeSlots.back();
+            idMapFreeSlots.pop_back();
+        }
+        else
+        {
+            index = firstNew + i - reused;
+        }
+        EntMapSlot& slot = idMap[index];
+        slot.entity = entities[i];
+        slot.generation++;
+        slot.sectorId = sectorId;
+        entityIds[i] = {index, slot.generation};
+    }
+}
+
 bool RegistryMapping::updateEntitySector(EntityId entityId, uint32_t sectorId, entt::entity entity)
 {
     if (!validId(entityId))
@@ -44,6 +72,26 @@ bool RegistryMapping::updateEntitySector(EntityId entityId, uint32_t sectorId, e
     return true;
 }
 
+uint32_t RegistryMapping::updateEntitySectors(
+    std::span<const EntityId> entityIds,
+    uint32_t sectorId,
+    std::span<const entt::entity> entities)
+{
+    uint32_t updated = 0;
+    for (size_t i = 0; i < entityIds.size(); i++)
+    {
+        if (!validId(entityIds[i]))
+        {
+            continue;
+        }
+        auto& ref = idMap[entityIds[i].index];
+        ref.entity = entities[i];
+        ref.sectorId = sectorId;
+        updated++;
+    }
+    return updated;
+}
+
 bool RegistryMapping::unregisterEntityId(EntityId entityId)
 {
     if (!validId(entityId))
@@ -3,6 +3,7 @@
 
 #include <comp-ident.hpp>
 #include <entt/entt.hpp>
+#include <span>
 #include <world-def.hpp>
 
 namespace ecs
@@ -23,8 +24,18 @@ class RegistryMapping
 
     // Manage EntityId lifecycle
     EntityId registerEntity(uint32_t sectorId, entt::entity entity);
+    // Allocates ids for a block of entities, entityIds[i] belongs to
+    // entities[i]. Reuses free slots first, then grows the map once
+    void registerEntities(uint32_t sectorId,
+                          std::span<const entt::entity> entities,
+                          std::span<EntityId> entityIds);
     bool unregisterEntityId(EntityId entityId);
     bool updateEntitySector(EntityId entityId, uint32_t sectorId, entt::entity entity);
+    // Batch version for migrations, entities[i] is the new entity of
+    // entityIds[i]. Returns the number of updated slots
+    uint32_t updateEntitySectors(std::span<const EntityId> entityIds,
+                                 uint32_t sectorId,
+                                 std::span<const entt::entity> entities);
     bool validId(EntityId entityId);
     const EntMapSlot* getEntity(EntityId entityId);
 
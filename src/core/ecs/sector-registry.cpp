@@ -4,6 +4,8 @@
 #include "logging.hpp"
 #include "ptr-handle.hpp"
 #include <asset-factory.hpp>
+#include <comp-ai.hpp>
+#include <frame-arena.hpp>
 #include <registry-mapping.hpp>
 #include <sector.hpp>
 
@@ -19,6 +21,39 @@ void SectorRegistry::init(RegistryMapping* registryMapping,
 {
     this->registryMapping = registryMapping;
     this->sector = sector;
+    // Create the groups up front so the storages are arranged while empty
+    motionGroup();
+    driveGroup();
+    anchorHierarchy.connect(registry);
+}
+
+const AnchorHierarchy& SectorRegistry::getAnchorHierarchy()
+{
+    anchorHierarchy.refresh(registry, *registryMapping, sector->getId());
+    return anchorHierarchy;
+}
+
+entt::entity SectorRegistry::resolve(const EntityId& entityId,
+                                     LocalRef& localRef)
+{
+    const uint32_t sectorId = sector->getId();
+    if (localRef.sectorId == sectorId)
+    {
+        const auto& entityIds = registry.storage<EntityId>();
+        if (entityIds.contains(localRef.entity)
+            && entityIds.get(localRef.entity) == entityId)
+        {
+            return localRef.entity;
+        }
+    }
+    const EntMapSlot* slot = registryMapping->getEntity(entityId);
+    if (!slot || slot->sectorId != sectorId)
+    {
+        localRef = LocalRef{};
+        return entt::null;
+    }
+    localRef = LocalRef{slot->entity, sectorId};
+    return slot->entity;
 }
 
 EntityId SectorRegistry::spawnObject(const SpawnCallback& spwnClb)
@@ -57,66 +92,191 @@ EntityId SectorRegistry::spawnObject(const SpawnCallback& spwnClb)
     return entityId;
 }
 
-bool SectorRegistry::migrateEntity(EntityId entityId,
-                                   const EntMapSlot* slot,
-                                   SectorRegistry* lastRegistry)
+void SectorRegistry::spawnObjects(std::span<entt::entity> entities,
+                                  std::span<EntityId> entityIds)
 {
-    if (!slot || !lastRegistry)
+    registry.create(entities.begin(), entities.end());
+    registryMapping->registerEntities(sector->getId(), entities, entityIds);
+    registry.insert<EntityId>(
+        entities.begin(), entities.end(), entityIds.begin());
+    registry.insert<SectorId>(
+        entities.begin(),
+        entities.end(),
+        SectorId{sector->getId(), sector->getCoordX(), sector->getCoordY()});
+    registry.insert<ecs::Flags>(entities.begin(), entities.end());
+}
+
+uint32_t SectorRegistry::migrateEntities(ecs::PtrHandle* ptrHandle,
+                                         std::span<const EntityId> entityIds,
+                                         world::Sector* lastSector)
+{
+    if (!lastSector || lastSector == sector || entityIds.empty())
     {
-        return false;
+        return 0;
     }
-    entt::entity newEntity = registry.create();
+    entt::registry& srcRegistry = *lastSector->getRegistry()->getRegistry();
+    auto* arena = &con::alloc::FrameArena::local();
 
-    // copy all components to this new entity
+    // Resolve the batch, drop ids that are gone or not in lastSector anymore
+    std::pmr::vector<EntityId> ids(arena);
+    std::pmr::vector<entt::entity> srcEntities(arena);
+    ids.reserve(entityIds.size());
+    srcEntities.reserve(entityIds.size());
+    for (const auto& entityId : entityIds)
+    {
+        const EntMapSlot* slot = registryMapping->getEntity(entityId);
+        if (!slot || slot->sectorId != lastSector->getId())
+        {
+            LG_W("Skip migration of {}, not in sector {}",
+                 entityId,
+                 lastSector->getId());
+            continue;
+        }
+        ids.push_back(entityId);
+        srcEntities.push_back(slot->entity);
+    }
+    if (ids.empty())
+    {
+        return 0;
+    }
+
+    // Release what is bound to the last sector before copying. Proxies are
+    // recreated in this sectors tree, task stacks move to this task system
+    auto& srcBroadphase = srcRegistry.storage<Broadphase>();
+    auto& srcAi = srcRegistry.storage<Ai>();
+    ai::TaskSystem& srcTaskSystem = lastSector->getTaskSystem();
+    ai::TaskSystem& dstTaskSystem = sector->getTaskSystem();
+    for (size_t i = 0; i < srcEntities.size(); i++)
+    {
+        const entt::entity entity = srcEntities[i];
+        if (srcBroadphase.contains(entity))
+        {
+            lastSector->destroyBroadphaseProxy(&srcBroadphase.get(entity));
+        }
+        if (!srcAi.contains(entity))
+        {
+            continue;
+        }
+        auto& ai = srcAi.get(entity);
+        ai::TaskStackHandle stackHandle(ai.stackHandle);
+        if (!stackHandle.isValid())
+        {
+            continue;
+        }
+        ai::TaskSystem* sourceSystem = &srcTaskSystem;
+        if (!sourceSystem->getTaskStack(stackHandle) && ptrHandle->taskSystem)
+        {
+            sourceSystem = ptrHandle->taskSystem;
+        }
+        auto newStackHandle =
+            sourceSystem->moveTaskStackTo(stackHandle, dstTaskSystem);
+        if (!newStackHandle.isValid())
+        {
+            LG_W("Failed to move task stack for entity {}, creating new stack",
+                 ids[i]);
+            newStackHandle =
+                dstTaskSystem.createTaskStack(ai::taskdata::Idle());
+        }
+        ai.stackHandle = newStackHandle.toGenericHandle();
+    }
 
-    // Update SectorId to reflect new sector
-    auto sectorId = registry.emplace_or_replace<ecs::SectorId>(
-        newEntity, sector->getId(), sector->getCoordX(), sector->getCoordY());
+    // Copy storage by storage instead of entity by entity
+    std::pmr::vector<entt::entity> dstEntities(ids.size(), entt::null, arena);
+    registry.create(dstEntities.begin(), dstEntities.end());
+    const auto& componentFactory = ptrHandle->assetFactory->componentFactory;
+    for (auto [storageId, storage] : srcRegistry.storage())
+    {
+        const auto* helper = componentFactory.getHelperByStorage(storageId);
+        if (helper && !storage.empty())
+        {
+            helper->bulkCopier(srcRegistry, srcEntities, registry, dstEntities);
+        }
+    }
+    for (size_t i = 0; i < dstEntities.size(); i++)
+    {
+        const entt::entity entity = dstEntities[i];
+        // Identity components are not managed by the component factory
+        registry.emplace<EntityId>(entity, ids[i]);
+        auto* srcFlags = srcRegistry.try_get<Flags>(srcEntities[i]);
+        auto& flags = registry.emplace<Flags>(entity);
+        if (srcFlags)
+        {
+            flags = *srcFlags;
+            flags.removeFlag(Flags::Flag::Moved);
+        }
+        registry.emplace_or_replace<SectorId>(
+            entity, sector->getId(), sector->getCoordX(), sector->getCoordY());
+        sector->objectInitBroadphase(ptrHandle, entity);
+    }
 
-    // Update slot in global registry map and delete old entity in last sector
-    if (!registryMapping->updateEntitySector(
-            entityId, sector->getId(), newEntity))
+    // Point the global mapping to the new entities and drop the old ones
+    const uint32_t updated =
+        registryMapping->updateEntitySectors(ids, sector->getId(), dstEntities);
+    if (updated != ids.size())
     {
-        LG_E("Couldn't update entities sector in global registry mapping");
-        lastRegistry->getRegistry()->destroy(slot->entity);
-        registry.destroy(newEntity);
-        registryMapping->unregisterEntityId(entityId);
-        return false;
+        LG_E("Updated {} of {} entities in global registry mapping",
+             updated,
+             ids.size());
     }
-    lastRegistry->getRegistry()->destroy(slot->entity);
-    return true;
+    anchorHierarchy.onEntitiesArrived(ids);
+    srcRegistry.destroy(srcEntities.begin(), srcEntities.end());
+    return ids.size();
 }
 
-bool SectorRegistry::destroyObject(ecs::PtrHandle* ptrHandle, EntityId entityId)
+uint32_t SectorRegistry::destroyObjects(ecs::PtrHandle* ptrHandle,
+                                        std::span<const EntityId> entityIds,
+                                        vector<EntityId>& destroyed)
 {
-    const EntMapSlot* slot = registryMapping->getEntity(entityId);
-    if (!slot)
+    std::pmr::vector<entt::entity> entities(&con::alloc::FrameArena::local());
+    entities.reserve(entityIds.size());
+    const size_t firstDestroyed = destroyed.size();
+    for (const auto& entityId : entityIds)
     {
-        LG_W("Slot invalid. Could not destroy object {}", entityId);
-        return false;
+        const EntMapSlot* slot = registryMapping->getEntity(entityId);
+        if (!slot || slot->sectorId != sector->getId())
+        {
+            LG_W("Slot invalid. Could not destroy object {}", entityId);
+            continue;
+        }
+        entities.push_back(slot->entity);
+        destroyed.push_back(entityId);
+    }
+    if (entities.empty())
+    {
+        return 0;
     }
 
-    // Call destruction functions of all components
-    for (auto helper :
-         ptrHandle->assetFactory->componentFactory.getComponentHelpers())
+    // Call destruction functions of the components the entities have, one
+    // pool at a time
+    for (const auto& hook :
+         ptrHandle->assetFactory->componentFactory.getDestroyHooks())
     {
-        if (helper.second.destroy)
+        auto* storage = registry.storage(hook.storageId);
+        if (!storage || storage->empty())
+        {
+            continue;
+        }
+        for (const entt::entity entity : entities)
         {
-            helper.second.destroy(ptrHandle, &registry, slot->entity, sector);
+            if (storage->contains(entity))
+            {
+                hook.destroy(ptrHandle, &registry, entity, sector);
+            }
         }
     }
-    registry.destroy(slot->entity);
+    registry.destroy(entities.begin(), entities.end());
 
     // todo: how to unlink all references? Or will this be done dynamically when
     // used?
 
-    bool res = registryMapping->unregisterEntityId(entityId);
-    if (!res)
+    for (size_t i = firstDestroyed; i < destroyed.size(); i++)
     {
-        LG_W("Unregistering entityId {} failed", entityId);
-        return false;
+        if (!registryMapping->unregisterEntityId(destroyed[i]))
+        {
+            LG_W("Unregistering entityId {} failed", destroyed[i]);
+        }
     }
-    return true;
+    return entities.size();
 }
 
 }  // namespace ecs
\ No newline at end of file
@@ -2,12 +2,15 @@
 #define SECTOR_REGISTRY_HPP
 
 #include "entt/entity/fwd.hpp"
+#include "anchor-hierarchy.hpp"
 #include "entt/entt.hpp"
 #include "ptr-handle.hpp"
 #include "registry-mapping.hpp"
 #include "task-system.hpp"
 #include <comp-ident.hpp>
+#include <comp-phy.hpp>
 #include <cstdint>
+#include <span>
 
 namespace world
 {
@@ -35,21 +38,57 @@ class SectorRegistry
     SectorRegistry();
     ~SectorRegistry();
     void init(RegistryMapping* registryMapping, world::Sector* sector);
-    bool migrateEntity(EntityId entityId,
-                       const EntMapSlot* slot,
-                       SectorRegistry* lastRegistry);
+    // Moves a batch of entities from lastSector into this registry. Returns
+    // the number of migrated entities, stale ids are skipped
+    uint32_t migrateEntities(ecs::PtrHandle* ptrHandle,
+                             std::span<const EntityId> entityIds,
+                             world::Sector* lastSector);
     EntityId spawnObject(const SpawnCallback& spwnClb);
-    bool destroyObject(ecs::PtrHandle* ptrHandle, EntityId entityId);
+    // Creates entities.size() entities with EntityId, SectorId and Flags,
+    // ids are allocated as one block
+    void spawnObjects(std::span<entt::entity> entities,
+                      std::span<EntityId> entityIds);
+    // Destroys a batch of entities. Destroy hooks run pool by pool, the
+    // entities are released with one range destroy. Ids of the destroyed
+    // entities are appended to destroyed, stale ids are skipped.
+    uint32_t destroyObjects(ecs::PtrHandle* ptrHandle,
+                            std::span<const EntityId> entityIds,
+                            vector<EntityId>& destroyed);
+
+    // Resolves a reference to an entity of this registry. The cached handle
+    // is trusted while it points to an entity of this sector that still
+    // carries entityId, otherwise it is refreshed through the global
+    // mapping. Returns entt::null if the entity is not in this sector.
+    entt::entity resolve(const EntityId& entityId, LocalRef& localRef);
 
     entt::registry* getRegistry()
     {
         return &registry;
     }
 
+    // Owning groups of the physics hot path. The owned storages are kept
+    // packed in the same order, so iterating a group walks them linearly
+    // instead of probing sparse sets. A storage can only be owned by one
+    // group, new hot groups must not own the components below.
+    auto motionGroup()
+    {
+        return registry.group<Transform, TransformCache, PhysicsBody>(
+            entt::get<EntityId, SectorId, Broadphase>);
+    }
+    auto driveGroup()
+    {
+        return registry.group<PhyThrust, MoveCtrl>(
+            entt::get<PhysicsBody, Transform, TransformCache, SectorId>);
+    }
+
+    // Parent -> children view of the AnchorFixed links, refreshed on access
+    const AnchorHierarchy& getAnchorHierarchy();
+
   private:
     world::Sector* sector;
     entt::registry registry;
     RegistryMapping* registryMapping;
+    AnchorHierarchy anchorHierarchy;
 };
 }  // namespace ecs
 
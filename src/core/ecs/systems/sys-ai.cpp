@@ -1,33 +1,191 @@
+#include <action.hpp>
+#include <frame-arena.hpp>
+#include <optional>
+#include <span>
 #include <sys-ai.hpp>
+#include <work-distributor.hpp>
 
 namespace ecs
 {
 #ifdef SERVER
+namespace
+{
+
+// Rescheduled wakeups are spread by up to 1/kAiJitterDiv of their interval,
+// so stacks spawned in one burst drift apart instead of waking together
+constexpr uint32_t kAiJitterDiv = 8;
+// Due stacks per decide chunk, every chunk collects its own actions
+constexpr size_t kAiChunkSize = 64;
+
+// ai and taskStack point into the Ai storage and the task stack pool of the
+// sector. They are only valid while both stay unchanged, i.e. from the
+// collection until the end of the decide phase: tasks read the registry and
+// push tasks through their action buffer, only apply() may add or remove
+// components or stacks.
+struct DueStack
+{
+    entt::entity entity;
+    EntityId entityId;
+    Ai* ai;
+    ai::TaskStack* taskStack;
+    // Priority of the stack raised by its waiting time
+    ai::TaskPriority priority;
+    uint32_t nextRunFrame;
+};
+
+// Every agingFrames a due stack waits it moves up one priority, so lasting
+// combat load delays Normal and Background stacks but never starves them
+ai::TaskPriority agedPriority(ai::TaskPriority priority,
+                              uint32_t waitedFrames,
+                              uint32_t agingFrames)
+{
+    if (agingFrames == 0)
+    {
+        return priority;
+    }
+    const uint32_t aged =
+        static_cast<uint32_t>(priority) + waitedFrames / agingFrames;
+    return static_cast<ai::TaskPriority>(
+        std::min(aged, static_cast<uint32_t>(ai::TaskPriority::Combat)));
+}
+
+inline uint32_t jitterHash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Decide phase of one chunk. The registry is only read, the chunk writes its
+// own action buffer and the task stacks and Ai schedules of its entities, so
+// chunks share no state and run on any worker. Stops once the budget ran
+// out.
+void decideChunk(std::span<const DueStack> chunk,
+                 const entt::registry& reg,
+                 world::Sector* sector,
+                 PtrHandle* ptrHandle,
+                 ai::ActionBuffer& actions,
+                 long deadlineU,
+                 bool runFirst)
+{
+    const uint32_t frame = ptrHandle->frameCnt;
+    for (const auto& dueStack : chunk)
+    {
+        // At least one stack runs per tick, so a slow task cannot stall
+        // the others forever
+        if (!(runFirst && &dueStack == chunk.data())
+            && tim::nowU() > deadlineU)
+        {
+            return;
+        }
+        auto& ai = *dueStack.ai;
+        ai::TaskFunArgs args = {dueStack.entityId,
+                                dueStack.entity,
+                                ptrHandle,
+                                &ai.nextRunFrame,
+                                sector,
+                                &reg,
+                                &actions,
+                                dueStack.taskStack};
+        dueStack.taskStack->runTask(&args);
+        const uint32_t interval = ai.nextRunFrame - frame;
+        if (ai.nextRunFrame > frame && interval >= kAiJitterDiv)
+        {
+            ai.nextRunFrame += jitterHash(dueStack.entityId.index ^ frame)
+                               % (interval / kAiJitterDiv + 1);
+        }
+    }
+}
+
+}  // namespace
+
 void sysAiImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
     auto* reg = sector->getRegistry()->getRegistry();
-    reg->view<EntityId, Ai>().each(
-        [ptrHandle, sector](auto entity, auto& entityId, auto& ai)
+    auto& taskSystem = sector->getTaskSystem();
+    const uint32_t frame = ptrHandle->frameCnt;
+    auto* arena = &con::alloc::FrameArena::local();
+
+    const uint32_t agingFrames = ptrHandle->aiAgingFrames;
+    std::pmr::vector<DueStack> due(arena);
+    reg->view<Ai, EntityId>().each(
+        [&due, &taskSystem, frame, agingFrames](
+            auto entity, auto& ai, auto& entityId)
         {
-            if (ai.active)
+            if (!ai.active || frame < ai.nextRunFrame)
+            {
+                return;
+            }
+            auto* taskStack = taskSystem.getTaskStack(ai.stackHandle);
+            if (taskStack)
             {
-                if (ptrHandle->frameCnt < ai.nextRunFrame)
-                {
-                    // LG_D("sysAi: nextRunFrame: {}, frameCnt: {}",
-                    //      ai->nextRunFrame,
-                    //      ptrHandle->frameCnt);
-                    return;
-                }
-                auto& taskSystem = sector->getTaskSystem();
-                auto* taskStack = taskSystem.getTaskStack(ai.stackHandle);
-                if (taskStack)
-                {
-                    ai::TaskFunArgs args = {
-                        entityId, entity, ptrHandle, &ai.nextRunFrame, sector};
-                    taskStack->runTask(&args);
-                }
+                due.push_back({entity,
+                               entityId,
+                               &ai,
+                               taskStack,
+                               agedPriority(taskStack->getPriority(),
+                                            frame - ai.nextRunFrame,
+                                            agingFrames),
+                               ai.nextRunFrame});
             }
         });
+    if (due.empty())
+    {
+        return;
+    }
+    // Highest aged priority first, then the stacks that waited longest
+    std::sort(due.begin(),
+              due.end(),
+              [](const DueStack& a, const DueStack& b)
+              {
+                  if (a.priority != b.priority)
+                  {
+                      return a.priority > b.priority;
+                  }
+                  return a.nextRunFrame < b.nextRunFrame;
+              });
+
+    // Station graph changes only here, the tasks plan against it read-only
+    sector->getNavGraph().refresh(*reg);
+
+    // Decide: nothing but the task stacks and schedules is written until
+    // all chunks are done, the chunks see the same registry state. Chunks
+    // start in priority order, due stacks that do not fit the budget stay
+    // due and age further.
+    const long deadlineU = tim::nowU() + ptrHandle->aiBudgetU;
+    const entt::registry& snapshot = *reg;
+    const size_t numChunks = (due.size() + kAiChunkSize - 1) / kAiChunkSize;
+    std::pmr::vector<std::optional<ai::ActionBuffer>> chunkActions(numChunks,
+                                                                   arena);
+    ptrHandle->workDistributor->parallelFor(
+        numChunks,
+        [&](size_t chunkIdx)
+        {
+            const size_t begin = chunkIdx * kAiChunkSize;
+            const std::span<const DueStack> chunk(
+                due.data() + begin,
+                std::min(kAiChunkSize, due.size() - begin));
+            // Arenas are per thread, the buffer uses the one of the worker
+            // that runs the chunk
+            auto& actions = chunkActions[chunkIdx].emplace(
+                &con::alloc::FrameArena::local());
+            decideChunk(chunk,
+                        snapshot,
+                        sector,
+                        ptrHandle,
+                        actions,
+                        deadlineU,
+                        chunkIdx == 0);
+        });
+
+    // Apply: one pass over the actions in chunk order
+    for (auto& actions : chunkActions)
+    {
+        actions->apply(*reg, taskSystem, frame);
+    }
 }
 #endif
-}  // namespace ecs
\ No newline at end of file
+}  // namespace ecs
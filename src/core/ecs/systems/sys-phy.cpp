@@ -9,8 +9,11 @@
 #include <comp-phy.hpp>
 #include <comp-storage.hpp>
 #include <comp-struct.hpp>
+#include <def-cache.hpp>
+#include <frame-arena.hpp>
 #include <optional>
 #include <sys-phy.hpp>
+#include <work-distributor.hpp>
 #include <engine.hpp>
 
 namespace ecs
@@ -31,244 +34,561 @@ constexpr float kContactPenetrationSlop = 0.005f;
 constexpr float kContactMaxBiasSpeed = 3.0f;
 constexpr int kContactSolverIterations = 5;
 
-void sysMoveCtrlImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
+// Local avoidance: bodies are discs around their AABB, scaled by
+// kAvoidRadiusScale for clearance. Overlapping discs are pushed apart within
+// kAvoidSeparationTime seconds.
+constexpr float kAvoidRadiusScale = 1.2f;
+constexpr float kAvoidSeparationTime = 0.5f;
+// Agents per avoidance chunk, chunks run on any worker
+constexpr size_t kAvoidChunkSize = 64;
+// Frames between exact cos / sin updates of a rotating body when its
+// TransformCache is integrated as a unit complex
+constexpr uint32_t kRotResyncFrames = 64;
+
+namespace
 {
-    auto* reg = sector->getRegistry()->getRegistry();
-    reg->view<SectorId,
-              MoveCtrl,
-              Transform,
-              TransformCache,
-              PhysicsBody,
-              PhyThrust>()
-        .each(
-            [ptrHandle](auto entity,
-                        auto& sectorId,
-                        auto& moveCtrl,
-                        auto& transform,
-                        auto& transformCache,
-                        auto& physicsBody,
-                        auto& phyThrust)
-            {
-                vec2 d_w;
-                vec2 d_l;
-                float d_l_mag;
-                bool calcLocalSpaceVectorsDone = false;
-                const float s = transformCache.s;
-                const float c = transformCache.c;
-
-                auto calcLocalSpaceVectors = [&](def::SectorCoords trgt)
-                {
-                    vec2 relTargetPos =
-                        (trgt.pos.toVec2() - sectorId.toVec2())
-                            * ptrHandle->world->getWorldShape().sectorSize
-                        + trgt.sectorPos;
-                    d_w = relTargetPos - transform.pos;
-                    d_l = smath::rotateVec2(d_w, -s, c);
-                    d_l_mag = glm::length(d_l);
-                    calcLocalSpaceVectorsDone = true;
-                };
-
-                auto ctrlPos = [&](def::SectorCoords trgt)
-                {
-                    // Thrust control =====================
-                    const float m = physicsBody.mass;
-                    const vec2 v_vel = physicsBody.vel;
-                    const vec2 v_vel_l = smath::rotateVec2(v_vel, -s, c);
-                    const float v = glm::length(v_vel);
 
+// Ships per controller batch. The lanes live on the stack, a batch is
+// gathered, run through its kernel and scattered before the next one.
+constexpr uint32_t kCtrlBatchSize = 64;
 
-                    vec2 v_des_l = vec2(0.0f, 0.0f);
+// MoveTo position law, structure of arrays in ship local space
+struct PosCtrlBatch
+{
+    uint32_t count = 0;
+    PhyThrust* phyThrust[kCtrlBatchSize];
+    MoveCtrl* moveCtrl[kCtrlBatchSize];
+    float s[kCtrlBatchSize];
+    float c[kCtrlBatchSize];
+    // In: target offset, velocity and limits
+    float dx[kCtrlBatchSize];
+    float dy[kCtrlBatchSize];
+    float vx[kCtrlBatchSize];
+    float vy[kCtrlBatchSize];
+    float mass[kCtrlBatchSize];
+    float thrustManeuverMax[kCtrlBatchSize];
+    float thrustMainMax[kCtrlBatchSize];
+    float maxSpd[kCtrlBatchSize];
+    float allowedPosError[kCtrlBatchSize];
+    // Out: thrust and desired velocity, local space
+    float thrustX[kCtrlBatchSize];
+    float thrustY[kCtrlBatchSize];
+    float desX[kCtrlBatchSize];
+    float desY[kCtrlBatchSize];
+    uint8_t reached[kCtrlBatchSize];
+    uint8_t deadzone[kCtrlBatchSize];
+};
 
-                    moveCtrl.posReached = d_l_mag < moveCtrl.allowedPosError;
-                    if (!moveCtrl.posReached)
-                    {
-                        // t_ml: maximum thrust vector in object local space and
-                        // target direction
-                        const float tm_x = phyThrust.thrustManeuverMax;
-                        const float tm_y = phyThrust.thrustMainMax;
-                        const float absX = fabsf(d_l.x);
-                        const float absY = fabsf(d_l.y);
-                        const float k_t =
-                            std::min(tm_x / std::max(absX, 1e-4f),
-                                     tm_y / std::max(absY, 1e-4f));
-                        const vec2 t_ml = k_t * d_l;
-                        // t_m: maximum thrust magnitude
-                        // a_m: maximum acceleration
-                        // v_m: desired velocity
-                        const float t_m = glm::length(t_ml);
-                        const float a_m = t_m / m;
-                        const float v_m = sqrtf(2.0f * a_m * d_l_mag);
-                        // v_des: desired velocity magnitude
-                        // v_des_l: desired velocity in object local space
-                        const float v_des =
-                            std::min(velMargin * v_m, phyThrust.maxSpd);
-                        v_des_l = v_des * d_l / d_l_mag;
-                    }
+// Forward heading law, angle errors are computed while gathering
+struct TurnCtrlBatch
+{
+    uint32_t count = 0;
+    PhyThrust* phyThrust[kCtrlBatchSize];
+    MoveCtrl* moveCtrl[kCtrlBatchSize];
+    // In, the heading error is not wrapped yet
+    float angleErr[kCtrlBatchSize];
+    float rotVel[kCtrlBatchSize];
+    float inertia[kCtrlBatchSize];
+    float maxTorque[kCtrlBatchSize];
+    float maxRotVel[kCtrlBatchSize];
+    float allowedRotError[kCtrlBatchSize];
+    // Out
+    float torque[kCtrlBatchSize];
+    uint8_t reached[kCtrlBatchSize];
+};
 
-                    const bool inPosDeadzone =
-                        d_l_mag < posDeadband && v < velDeadband;
-                    if (inPosDeadzone)
-                    {
-                        phyThrust.setThrustNone();
-                    }
-                    else
+// Branch free loops over the lanes, selects instead of ifs, so the compiler
+// vectorizes them for the target instruction set (4 / 8 ships with SSE /
+// AVX). That needs -fno-math-errno and -fno-trapping-math for this file
+// (see the server CMakeLists), otherwise sqrtf and the selects around
+// divisions keep the loops scalar.
+void posCtrlKernel(PosCtrlBatch& b, float kpThrust)
+{
+    for (uint32_t i = 0; i < b.count; i++)
+    {
+        const float dMag = sqrtf(b.dx[i] * b.dx[i] + b.dy[i] * b.dy[i]);
+        // Largest thrust along the target direction inside the actuator box
+        const float k_t =
+            std::min(b.thrustManeuverMax[i] / std::max(fabsf(b.dx[i]), 1e-4f),
+                     b.thrustMainMax[i] / std::max(fabsf(b.dy[i]), 1e-4f));
+        const float a_m = k_t * dMag / b.mass[i];
+        const float v_m = sqrtf(2.0f * a_m * dMag);
+        const float v_des = std::min(velMargin * v_m, b.maxSpd[i]);
+        const bool reached = dMag < b.allowedPosError[i];
+        const float k_des = reached ? 0.0f : v_des / std::max(dMag, 1e-12f);
+        b.desX[i] = k_des * b.dx[i];
+        b.desY[i] = k_des * b.dy[i];
+        const float v = sqrtf(b.vx[i] * b.vx[i] + b.vy[i] * b.vy[i]);
+        b.reached[i] = reached;
+        b.deadzone[i] = dMag < posDeadband && v < velDeadband;
+        b.thrustX[i] = kpThrust * b.mass[i] * (b.desX[i] - b.vx[i]);
+        b.thrustY[i] = kpThrust * b.mass[i] * (b.desY[i] - b.vy[i]);
+    }
+}
+
+void turnCtrlKernel(TurnCtrlBatch& b, float kpTurn)
+{
+    for (uint32_t i = 0; i < b.count; i++)
+    {
+        // Fast path of smath::angleError, the gather wrapped the rest
+        float err = b.angleErr[i];
+        err = err >= M_PIf ? err - 2.0f * M_PIf : err;
+        err = err < -M_PIf ? err + 2.0f * M_PIf : err;
+        const float absErr = fabsf(err);
+        const float maxAngAcc = b.maxTorque[i] / b.inertia[i];
+        const float desWMag =
+            velMargin * sqrtf(std::max(0.0f, 2.0f * maxAngAcc * absErr));
+        float desW = std::min(desWMag, std::max(0.0f, b.maxRotVel[i]));
+        desW = err < 0.0f ? -desW : err > 0.0f ? desW : 0.0f;
+        const bool deadzone =
+            absErr < rotDeadband && fabsf(b.rotVel[i]) < rotVelDeadband;
+        b.torque[i] =
+            deadzone ? 0.0f
+                     : kpTurn * (desW - b.rotVel[i]) * b.inertia[i];
+        b.reached[i] = absErr < b.allowedRotError[i];
+    }
+}
+
+void flushPosCtrl(PosCtrlBatch& b, float kpThrust)
+{
+    posCtrlKernel(b, kpThrust);
+    for (uint32_t i = 0; i < b.count; i++)
+    {
+        auto& moveCtrl = *b.moveCtrl[i];
+        moveCtrl.posReached = b.reached[i];
+        if (b.deadzone[i])
+        {
+            b.phyThrust[i]->setThrustNone();
+        }
+        else
+        {
+            b.phyThrust[i]->setThrustLocal(
+                vec2(b.thrustX[i], b.thrustY[i]), b.s[i], b.c[i]);
+            moveCtrl.desiredVel = smath::rotateVec2(
+                vec2(b.desX[i], b.desY[i]), b.s[i], b.c[i]);
+            moveCtrl.desiredVelActive = true;
+        }
+    }
+    b.count = 0;
+}
+
+void flushTurnCtrl(TurnCtrlBatch& b, float kpTurn)
+{
+    turnCtrlKernel(b, kpTurn);
+    for (uint32_t i = 0; i < b.count; i++)
+    {
+        b.moveCtrl[i]->rotReached = b.reached[i];
+        b.phyThrust[i]->setTorque(b.torque[i]);
+    }
+    b.count = 0;
+}
+
+}  // namespace
+
+// Controllers run bucketed by mode: MoveTo and Forward, the laws every AI
+// ship runs, are gathered into lane batches and evaluated by the kernels
+// above. The remaining modes are cheap and stay scalar. Thrust is handled in
+// a first pass and torque in a second, as setThrustNone() clears the torque.
+void sysMoveCtrlImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
+{
+    const float sectorSize = ptrHandle->world->getWorldShape().sectorSize;
+    const float kpThrust = ptrHandle->kpThrust;
+    const float kpTurn = ptrHandle->kpTurn;
+    auto group = sector->getRegistry()->driveGroup();
+
+    auto localTarget = [sectorSize](const def::SectorCoords& trgt,
+                                    const Transform& transform,
+                                    const SectorId& sectorId)
+    {
+        const vec2 relTargetPos =
+            (trgt.pos.toVec2() - sectorId.toVec2()) * sectorSize
+            + trgt.sectorPos;
+        return relTargetPos - transform.pos;
+    };
+
+    PosCtrlBatch posBatch;
+    group.each(
+        [&](auto entity,
+            auto& phyThrust,
+            auto& moveCtrl,
+            auto& physicsBody,
+            auto& transform,
+            auto& transformCache,
+            auto& sectorId)
+        {
+            const float s = transformCache.s;
+            const float c = transformCache.c;
+            const float m = physicsBody.mass;
+            const vec2 v_vel_l = smath::rotateVec2(physicsBody.vel, -s, c);
+            moveCtrl.desiredVelActive = false;
+            switch (moveCtrl.moveMode)
+            {
+                case MoveCtrl::MoveMode::MoveTo:
+                {
+                    const vec2 d_l = smath::rotateVec2(
+                        localTarget(moveCtrl.spPos, transform, sectorId),
+                        -s,
+                        c);
+                    const uint32_t i = posBatch.count++;
+                    posBatch.phyThrust[i] = &phyThrust;
+                    posBatch.moveCtrl[i] = &moveCtrl;
+                    posBatch.s[i] = s;
+                    posBatch.c[i] = c;
+                    posBatch.dx[i] = d_l.x;
+                    posBatch.dy[i] = d_l.y;
+                    posBatch.vx[i] = v_vel_l.x;
+                    posBatch.vy[i] = v_vel_l.y;
+                    posBatch.mass[i] = m;
+                    posBatch.thrustManeuverMax[i] = phyThrust.thrustManeuverMax;
+                    posBatch.thrustMainMax[i] = phyThrust.thrustMainMax;
+                    posBatch.maxSpd[i] = phyThrust.maxSpd;
+                    posBatch.allowedPosError[i] = moveCtrl.allowedPosError;
+                    if (posBatch.count == kCtrlBatchSize)
                     {
-                        const vec2 err = v_des_l - v_vel_l;
-                        const vec2 thrust = ptrHandle->kpThrust * m * err;
-                        phyThrust.setThrustLocal(thrust, s, c);
+                        flushPosCtrl(posBatch, kpThrust);
                     }
-                };
-
-                auto ctrlVelLoc = [&](vec2 trgt)
+                    break;
+                }
+                case MoveCtrl::MoveMode::Brake:
                 {
-                    const float m = physicsBody.mass;
-                    const vec2 v_vel = physicsBody.vel;
-                    const vec2 v_vel_l = smath::rotateVec2(v_vel, -s, c);
-                    const vec2 err = trgt - v_vel_l;
-                    const vec2 thrust = ptrHandle->kpThrust * m * err;
+                    const vec2 thrust = kpThrust * m * -v_vel_l;
                     phyThrust.setThrustLocal(thrust, s, c);
-                };
-
-                auto ctrlVelLocMain = [&](float trgt)
+                    break;
+                }
+                case MoveCtrl::MoveMode::BrakeMain:
                 {
-                    const float m = physicsBody.mass;
-                    const vec2 v_vel = physicsBody.vel;
-                    const float v_vel_l_main =
-                        smath::rotateVec2(v_vel, -s, c).y;
-                    const float err = trgt - v_vel_l_main;
-                    const float thrust = ptrHandle->kpThrust * m * err;
-                    phyThrust.setThrustLocalMain(thrust, s, c);
-                };
-
-                auto ctrlVelLocManeuver = [&](float trgt)
+                    phyThrust.setThrustLocalMain(
+                        kpThrust * m * -v_vel_l.y, s, c);
+                    break;
+                }
+                case MoveCtrl::MoveMode::BrakeManeuver:
                 {
-                    const float m = physicsBody.mass;
-                    const vec2 v_vel = physicsBody.vel;
-                    const float v_vel_l_maneuver =
-                        smath::rotateVec2(v_vel, -s, c).x;
-                    const float err = trgt - v_vel_l_maneuver;
-                    const float thrust = ptrHandle->kpThrust * m * err;
-                    phyThrust.setThrustLocalManeuver(thrust, s, c);
-                };
-
-                switch (moveCtrl.moveMode)
+                    phyThrust.setThrustLocalManeuver(
+                        kpThrust * m * -v_vel_l.x, s, c);
+                    break;
+                }
+                default:
+                    break;
+            }
+        });
+    flushPosCtrl(posBatch, kpThrust);
+
+    TurnCtrlBatch turnBatch;
+    group.each(
+        [&](auto entity,
+            auto& phyThrust,
+            auto& moveCtrl,
+            auto& physicsBody,
+            auto& transform,
+            auto& transformCache,
+            auto& sectorId)
+        {
+            auto ctrlW = [&](float trgt)
+            {
+                const float werr = trgt - physicsBody.rotVel;
+                phyThrust.setTorque(kpTurn * werr * physicsBody.inertia);
+            };
+
+            switch (moveCtrl.turnMode)
+            {
+                case MoveCtrl::TurnMode::Forward:
                 {
-                    case MoveCtrl::MoveMode::MoveTo:
+                    const vec2 d_w =
+                        localTarget(moveCtrl.spPos, transform, sectorId);
+                    const float minFFDist =
+                        std::get<MoveCtrl::MCForwardData>(
+                            moveCtrl.faceDirData)
+                            .minFaceForwardDist;
+                    // Rotation keeps the length, no need for local space
+                    if (glm::length(d_w) > minFFDist)
                     {
-                        calcLocalSpaceVectors(moveCtrl.spPos);
-                        ctrlPos(moveCtrl.spPos);
-                        break;
+                        // World is Y-down; sprites use local +Y as forward.
+                        // After CW rotation by `rot`, local +Y maps to
+                        // (-sin(rot), cos(rot)) in world — align that with
+                        // dir.
+                        // atan2f has no vector variant without fast math,
+                        // it stays here
+                        moveCtrl.spRot = atan2f(-d_w.x, d_w.y);
                     }
-                    case MoveCtrl::MoveMode::Brake:
+                    // The kernel wraps errors within one turn, only a far
+                    // off spRot (e.g. from the config) is wrapped here
+                    float angleErr = moveCtrl.spRot - transform.rot;
+                    if (fabsf(angleErr) >= 3.0f * M_PIf)
                     {
-                        ctrlVelLoc(vec2(0.0f, 0.0f));
-                        break;
+                        angleErr =
+                            smath::angleError(moveCtrl.spRot, transform.rot);
                     }
-                    case MoveCtrl::MoveMode::BrakeMain:
+                    const uint32_t i = turnBatch.count++;
+                    turnBatch.phyThrust[i] = &phyThrust;
+                    turnBatch.moveCtrl[i] = &moveCtrl;
+                    turnBatch.angleErr[i] = angleErr;
+                    turnBatch.rotVel[i] = physicsBody.rotVel;
+                    turnBatch.inertia[i] = physicsBody.inertia;
+                    turnBatch.maxTorque[i] = phyThrust.maxTorque;
+                    turnBatch.maxRotVel[i] = phyThrust.maxRotVel;
+                    turnBatch.allowedRotError[i] = moveCtrl.allowedRotError;
+                    if (turnBatch.count == kCtrlBatchSize)
                     {
-                        ctrlVelLocMain(0.0f);
-                        break;
+                        flushTurnCtrl(turnBatch, kpTurn);
                     }
-                    case MoveCtrl::MoveMode::BrakeManeuver:
-                    {
-                        ctrlVelLocManeuver(0.0f);
-                        break;
-                    }
-                    default:
-                        break;
                 }
-
-                // Torque control =====================
-                auto ctrlAngle = [&](float trgt)
+                break;
+                case MoveCtrl::TurnMode::TargetPoint:
                 {
-                    const float angleErr =
-                        smath::angleError(trgt, transform.rot);
-                    moveCtrl.rotReached =
-                        std::abs(angleErr) < moveCtrl.allowedRotError;
-                    const float maxAngAcc =
-                        phyThrust.maxTorque / physicsBody.inertia;
-                    const float desWMag =
-                        velMargin
-                        * std::sqrt(std::max(
-                            0.0f, 2.0f * maxAngAcc * std::abs(angleErr)));
-                    const float maxRotVel = std::max(0.0f, phyThrust.maxRotVel);
-                    float desW = std::min(desWMag, maxRotVel);
-                    desW *= glm::sign(angleErr);
-                    const bool inRotDeadzone =
-                        std::abs(angleErr) < rotDeadband
-                        && std::abs(physicsBody.rotVel) < rotVelDeadband;
-                    if (inRotDeadzone)
-                    {
-                        phyThrust.setTorque(0.0f);
-                    }
-                    else
+                    vec2 tgtDir = vec2(moveCtrl.lookAt.x - transform.pos.x,
+                                       moveCtrl.lookAt.y - transform.pos.y);
+                    if (fabs(tgtDir.x) + fabs(tgtDir.y)
+                        > ptrHandle->minFaceTargetDist)
                     {
-                        const float werr = desW - physicsBody.rotVel;
-                        float trq =
-                            ptrHandle->kpTurn * werr * physicsBody.inertia;
-                        phyThrust.setTorque(trq);
+                        moveCtrl.spRot = atan2f(-tgtDir.x, tgtDir.y);
                     }
-                };
-
-                auto ctrlW = [&](float trgt)
+                    ctrlW(moveCtrl.spRot);
+                }
+                break;
+                case MoveCtrl::TurnMode::Brake:
                 {
-                    const float werr = trgt - physicsBody.rotVel;
-                    float trq = ptrHandle->kpTurn * werr * physicsBody.inertia;
-                    phyThrust.setTorque(trq);
-                };
+                    ctrlW(0.0f);
+                }
+                break;
+                default:
+                    break;
+            }
+        });
+    flushTurnCtrl(turnBatch, kpTurn);
+}
+
+namespace
+{
+
+struct AvoidAgent
+{
+    entt::entity entity;
+    vec2 pos;
+    vec2 desiredVel;
+    float radius;
+    float maxSpd;
+    // Into the neighbour list of the chunk of the agent
+    uint32_t firstNeighbor;
+    uint32_t numNeighbors;
+};
+
+struct AvoidNeighbor
+{
+    vec2 pos;
+    vec2 vel;
+    float radius;
+    // Agents on both sides avoid, each takes half of the correction
+    float share;
+};
+
+inline float avoidRadius(const Broadphase& broadphase)
+{
+    return 0.5f * kAvoidRadiusScale
+           * glm::length(broadphase.fatAABB.upper - broadphase.fatAABB.lower);
+}
+
+// Predicted closest approach within the horizon, the desired velocity is
+// changed just enough to move it to the edge of the combined radius
+vec2 avoidVelocity(const AvoidAgent& agent,
+                   std::span<const AvoidNeighbor> neighbors,
+                   float horizon)
+{
+    vec2 correction(0.0f);
+    for (const auto& neighbor : neighbors)
+    {
+        const vec2 p = neighbor.pos - agent.pos;
+        const float r = agent.radius + neighbor.radius;
+        const float dist = glm::length(p);
+        if (dist < r)
+        {
+            const vec2 away = dist > 1e-4f ? -p / dist : vec2(1.0f, 0.0f);
+            correction +=
+                away * ((r - dist) / kAvoidSeparationTime) * neighbor.share;
+            continue;
+        }
+        const vec2 vRel = agent.desiredVel - neighbor.vel;
+        const float vRel2 = glm::dot(vRel, vRel);
+        if (vRel2 < 1e-8f)
+        {
+            continue;
+        }
+        const float t = glm::dot(p, vRel) / vRel2;
+        if (t <= 0.0f || t > horizon)
+        {
+            continue;
+        }
+        const vec2 closest = p - vRel * t;
+        const float d = glm::length(closest);
+        if (d >= r)
+        {
+            continue;
+        }
+        // Head on: always pass on the same side
+        const vec2 away = d > 1e-4f ? -closest / d
+                                    : vec2(vRel.y, -vRel.x) / sqrtf(vRel2);
+        correction += away * ((r - d) / t) * neighbor.share;
+    }
+    vec2 vel = agent.desiredVel + correction;
+    const float spd = glm::length(vel);
+    if (spd > agent.maxSpd && spd > 1e-8f)
+    {
+        vel *= agent.maxSpd / spd;
+    }
+    return vel;
+}
+
+}  // namespace
+
+void sysAvoidanceImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
+{
+    const float horizon = ptrHandle->avoidHorizon;
+    if (horizon <= 0.0f)
+    {
+        return;
+    }
+    auto* reg = sector->getRegistry()->getRegistry();
+    auto* arena = &con::alloc::FrameArena::local();
+    auto& broadphases = reg->storage<Broadphase>();
 
-                switch (moveCtrl.turnMode)
+    // Snapshot the agents, everything below only reads the snapshot and
+    // the poses, so the agents are independent of each other
+    std::pmr::vector<AvoidAgent> agents(arena);
+    sector->getRegistry()->driveGroup().each(
+        [&agents, &broadphases](auto entity,
+                                auto& phyThrust,
+                                auto& moveCtrl,
+                                auto& physicsBody,
+                                auto& transform,
+                                auto& transformCache,
+                                auto& sectorId)
+        {
+            if (moveCtrl.moveMode != MoveCtrl::MoveMode::MoveTo
+                || !moveCtrl.desiredVelActive || !broadphases.contains(entity))
+            {
+                return;
+            }
+            agents.push_back({entity,
+                              transform.pos,
+                              moveCtrl.desiredVel,
+                              avoidRadius(broadphases.get(entity)),
+                              phyThrust.maxSpd,
+                              0,
+                              0});
+        });
+    if (agents.empty())
+    {
+        return;
+    }
+
+    // One broadphase query per agent over the box it can reach within the
+    // horizon. Anchored parts move with their parent and are skipped. The
+    // storages are fetched here, the chunks below only read.
+    auto& transforms = reg->storage<Transform>();
+    auto& bodies = reg->storage<PhysicsBody>();
+    auto& anchors = reg->storage<AnchorFixed>();
+    auto& moveCtrls = reg->storage<MoveCtrl>();
+    auto gatherNeighbors = [&](AvoidAgent& agent,
+                               std::pmr::vector<AvoidNeighbor>& neighbors)
+    {
+        agent.firstNeighbor = neighbors.size();
+        const float reach =
+            2.0f * agent.radius + glm::length(agent.desiredVel) * horizon;
+        sector->queryBroadphase(
+            con::AABB{agent.pos - reach, agent.pos + reach},
+            [&](const world::BpUserData& data)
+            {
+                if (data.type != world::BpUserType::Ecs)
                 {
-                    case MoveCtrl::TurnMode::Forward:
-                    {
-                        if (!calcLocalSpaceVectorsDone)
-                        {
-                            calcLocalSpaceVectors(moveCtrl.spPos);
-                        }
-                        const float minFFDist =
-                            std::get<MoveCtrl::MCForwardData>(
-                                moveCtrl.faceDirData)
-                                .minFaceForwardDist;
-                        if (d_l_mag > minFFDist)
-                        {
-                            // World is Y-down; sprites use local +Y as forward.
-                            // After CW rotation by `rot`, local +Y maps to
-                            // (-sin(rot), cos(rot)) in world — align that with
-                            // dir.
-                            moveCtrl.spRot = atan2f(-d_w.x, d_w.y);
-                        }
-                        ctrlAngle(moveCtrl.spRot);
-                    }
-                    break;
-                    case MoveCtrl::TurnMode::TargetPoint:
-                    {
-                        vec2 tgtDir = vec2(moveCtrl.lookAt.x - transform.pos.x,
-                                           moveCtrl.lookAt.y - transform.pos.y);
-                        if (fabs(tgtDir.x) + fabs(tgtDir.y)
-                            > ptrHandle->minFaceTargetDist)
-                        {
-                            moveCtrl.spRot = atan2f(-tgtDir.x, tgtDir.y);
-                        }
-                        ctrlW(moveCtrl.spRot);
-                    }
-                    break;
-                    case MoveCtrl::TurnMode::Brake:
-                    {
-                        ctrlW(0.0f);
-                    }
-                    break;
-                    default:
-                        break;
+                    return;
+                }
+                const entt::entity other = data.data.ent;
+                if (other == agent.entity || !bodies.contains(other)
+                    || !transforms.contains(other) || anchors.contains(other)
+                    || !broadphases.contains(other))
+                {
+                    return;
                 }
+                const bool reciprocal =
+                    moveCtrls.contains(other)
+                    && moveCtrls.get(other).desiredVelActive
+                    && moveCtrls.get(other).moveMode
+                           == MoveCtrl::MoveMode::MoveTo;
+                neighbors.push_back({transforms.get(other).pos,
+                                     bodies.get(other).vel,
+                                     avoidRadius(broadphases.get(other)),
+                                     reciprocal ? 0.5f : 1.0f});
             });
+        agent.numNeighbors = neighbors.size() - agent.firstNeighbor;
+    };
+
+    // Gather and velocities are a pure function of the snapshot per agent.
+    // Every chunk keeps its neighbours on the arena of the thread running it
+    // and writes only its own agents and velocities.
+    std::pmr::vector<vec2> velocities(agents.size(), arena);
+    const size_t numChunks =
+        (agents.size() + kAvoidChunkSize - 1) / kAvoidChunkSize;
+    ptrHandle->workDistributor->parallelFor(
+        numChunks,
+        [&](size_t chunkIdx)
+        {
+            const size_t begin = chunkIdx * kAvoidChunkSize;
+            const size_t end =
+                std::min(begin + kAvoidChunkSize, agents.size());
+            std::pmr::vector<AvoidNeighbor> neighbors(
+                &con::alloc::FrameArena::local());
+            for (size_t i = begin; i < end; i++)
+            {
+                gatherNeighbors(agents[i], neighbors);
+            }
+            const std::span<const AvoidNeighbor> chunkNeighbors(neighbors);
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& agent = agents[i];
+                velocities[i] = avoidVelocity(
+                    agent,
+                    chunkNeighbors.subspan(agent.firstNeighbor,
+                                           agent.numNeighbors),
+                    horizon);
+            }
+        });
+
+    // Same velocity loop as sysMoveCtrl, on the corrected velocity
+    auto& phyThrusts = reg->storage<PhyThrust>();
+    auto& transformCaches = reg->storage<TransformCache>();
+    for (size_t i = 0; i < agents.size(); i++)
+    {
+        const auto& agent = agents[i];
+        if (agent.numNeighbors == 0 || velocities[i] == agent.desiredVel)
+        {
+            continue;
+        }
+        auto& moveCtrl = moveCtrls.get(agent.entity);
+        const auto& physicsBody = bodies.get(agent.entity);
+        const auto& transformCache = transformCaches.get(agent.entity);
+        const float s = transformCache.s;
+        const float c = transformCache.c;
+        moveCtrl.desiredVel = velocities[i];
+        const vec2 err =
+            smath::rotateVec2(velocities[i] - physicsBody.vel, -s, c);
+        phyThrusts.get(agent.entity)
+            .setThrustLocal(
+                ptrHandle->kpThrust * physicsBody.mass * err, s, c);
+    }
 }
 
 
 void sysPhyThrustImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
-    auto* reg = sector->getRegistry()->getRegistry();
-    reg->view<PhysicsBody, PhyThrust>().each(
-        [ptrHandle](auto entity, auto& physicsBody, auto& phyThrust)
+    // Every thruster is built together with a MoveCtrl, so the drive group
+    // covers all of them
+    sector->getRegistry()->driveGroup().each(
+        [ptrHandle](auto entity,
+                    auto& phyThrust,
+                    auto& moveCtrl,
+                    auto& physicsBody,
+                    auto& transform,
+                    auto& transformCache,
+                    auto& sectorId)
         {
             if (physicsBody.rotVel > phyThrust.maxRotVel
                 && phyThrust.torque > 0)
@@ -318,85 +638,93 @@ void sysPhyThrustImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 void sysPhysicsImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
     auto* reg = sector->getRegistry()->getRegistry();
-    reg->view<EntityId,
-              SectorId,
-              Transform,
-              TransformCache,
-              PhysicsBody,
-              Broadphase>()
-        .each(
-            [ptrHandle, dt, reg, sector](auto entity,
-                                         auto& entityId,
-                                         auto& sectorId,
-                                         auto& transform,
-                                         auto& transformCache,
-                                         auto& physicsBody,
-                                         auto& broadphase)
+    const uint32_t frame = ptrHandle->frameCnt;
+    sector->getRegistry()->motionGroup().each(
+        [ptrHandle, dt, reg, sector, frame](auto entity,
+                                            auto& transform,
+                                            auto& transformCache,
+                                            auto& physicsBody,
+                                            auto& entityId,
+                                            auto& sectorId,
+                                            auto& broadphase)
+        {
+            physicsBody.acc += -ptrHandle->linDrag * physicsBody.vel;
+            physicsBody.rotAcc +=
+                -ptrHandle->angDrag
+                * (physicsBody.rotVel - physicsBody.naturalRotation);
+            physicsBody.vel += physicsBody.acc * dt;
+            physicsBody.rotVel += physicsBody.rotAcc * dt;
+            bool hasSignificantSpd =
+                (fabsf(physicsBody.vel.x) + fabsf(physicsBody.vel.y)
+                 > 1e-6f);
+            bool hasSignificantRotSpd = (fabsf(physicsBody.rotVel) > 1e-5f);
+            if (hasSignificantRotSpd)
             {
-                physicsBody.acc += -ptrHandle->linDrag * physicsBody.vel;
-                physicsBody.rotAcc +=
-                    -ptrHandle->angDrag
-                    * (physicsBody.rotVel - physicsBody.naturalRotation);
-                physicsBody.vel += physicsBody.acc * dt;
-                physicsBody.rotVel += physicsBody.rotAcc * dt;
-                bool hasSignificantSpd =
-                    (fabsf(physicsBody.vel.x) + fabsf(physicsBody.vel.y)
-                     > 1e-6f);
-                bool hasSignificantRotSpd = (fabsf(physicsBody.rotVel) > 1e-5f);
-                if (hasSignificantRotSpd)
+                transform.rot += physicsBody.rotVel * dt;
+                if (transform.rot < 0.0f)
                 {
-                    transform.rot += physicsBody.rotVel * dt;
-                    if (transform.rot < 0.0f)
-                    {
-                        transform.rot += 2.0f * M_PIf;
-                    }
-                    else if (transform.rot >= 2.0f * M_PIf)
-                    {
-                        transform.rot -= 2.0f * M_PIf;
-                    }
-                    transformCache.c = cosf(transform.rot);
-                    transformCache.s = sinf(transform.rot);
+                    transform.rot += 2.0f * M_PIf;
+                }
+                else if (transform.rot >= 2.0f * M_PIf)
+                {
+                    transform.rot -= 2.0f * M_PIf;
                 }
-                if (hasSignificantSpd)
+                // The angle stays authoritative for serialization, the
+                // cache follows it as a unit complex and is resynced now and
+                // then to keep the float error from piling up
+                if (ptrHandle->complexRot
+                    && (frame + entityId.index) % kRotResyncFrames != 0)
                 {
-                    transform.pos += physicsBody.vel * dt;
+                    smath::rotateUnit(transformCache.c,
+                                      transformCache.s,
+                                      physicsBody.rotVel * dt);
                 }
+                else
+                {
+                    transformCache.c = cosf(transform.rot);
+                    transformCache.s = sinf(transform.rot);
+                }
+            }
+            if (hasSignificantSpd)
+            {
+                transform.pos += physicsBody.vel * dt;
+            }
 
-                auto* collider = reg->try_get<Collider>(entity);
-                if (collider && (hasSignificantSpd || hasSignificantRotSpd))
+            auto* collider = reg->try_get<Collider>(entity);
+            if (collider && (hasSignificantSpd || hasSignificantRotSpd))
+            {
+                const gobj::Collider* colliderDef =
+                    ptrHandle->defCache->getCollider(collider->colliderHandle);
+                con::AABB newAabb = calculateAABB(
+                    transform, transformCache, *collider, colliderDef);
+                if (broadphase.proxyId > Broadphase::INVALID_PROXY_ID)
                 {
-                    const gobj::Collider* colliderDef =
-                        collider->getColliderDef(ptrHandle->colliderLib);
-                    con::AABB newAabb = calculateAABB(
-                        transform, transformCache, *collider, colliderDef);
-                    if (broadphase.proxyId > Broadphase::INVALID_PROXY_ID)
-                    {
-                        sector->moveAabbProxy(broadphase.proxyId, newAabb);
-                    }
-                    broadphase.fatAABB = newAabb;
-                    sector->addBroadphaseQueryEntity(entity);
+                    sector->moveAabbProxy(broadphase.proxyId, newAabb);
                 }
+                broadphase.fatAABB = newAabb;
+                sector->addBroadphaseQueryEntity(entity);
+            }
 
-                // Check for sector switch
-                ptrHandle->world->checkSectorSwitchAfterMove(
-                    entityId, entity, &sectorId, &transform, ptrHandle);
-
-                // Reset acceleration after game update
-                physicsBody.acc = {0, 0};
-                physicsBody.rotAcc = 0;
-
-                /*
-                    1.check AABB bounds and recalculate if needed
-                    2. if recalculated fatAABB, moveProxy in aabbTree
-                    3. broad phase query for object
-                    4. SAT for broadphase results
-                */
-
-                // LG_D("PhysicsBody update for entity: {} PhysicsBody: {}",
-                // entity, *physicsBody); LG_D("Transform update for entity: {}
-                // Transform:
-                // {}", entity, *transform);
-            });
+            // Check for sector switch
+            ptrHandle->world->checkSectorSwitchAfterMove(
+                entityId, entity, &sectorId, &transform, ptrHandle);
+
+            // Reset acceleration after game update
+            physicsBody.acc = {0, 0};
+            physicsBody.rotAcc = 0;
+
+            /*
+                1.check AABB bounds and recalculate if needed
+                2. if recalculated fatAABB, moveProxy in aabbTree
+                3. broad phase query for object
+                4. SAT for broadphase results
+            */
+
+            // LG_D("PhysicsBody update for entity: {} PhysicsBody: {}",
+            // entity, *physicsBody); LG_D("Transform update for entity: {}
+            // Transform:
+            // {}", entity, *transform);
+        });
 }
 
 struct ColResolveParams
@@ -421,7 +749,7 @@ static float parentBreakupSpreadRadius(PtrHandle* ptrHandle,
         return 1.0f;
     }
     const gobj::Collider* collider =
-        ptrHandle->modManager->getColliderLib().getItem(parentDef.collider);
+        ptrHandle->defCache->getCollider(parentDef.collider);
     if (collider == nullptr || collider->vertices.empty())
     {
         return 1.0f;
@@ -453,6 +781,9 @@ spawnParentAsteroidChildren(PtrHandle* ptrHandle,
     const float spreadRadius = parentBreakupSpreadRadius(ptrHandle, parentDef);
     const vec2 center = parentTransform.pos;
     size_t spawnIndex = 0;
+    std::pmr::vector<objb::RecipeInstance> instances(
+        &con::alloc::FrameArena::local());
+    instances.reserve(totalSpawns);
 
     for (const gobj::AsteroidChildSpawn& entry : parentData.children)
     {
@@ -460,6 +791,14 @@ spawnParentAsteroidChildren(PtrHandle* ptrHandle,
         {
             continue;
         }
+        objb::AsteroidRecipe* recipe =
+            ptrHandle->defCache->getAsteroidRecipe(entry.first);
+        if (!recipe)
+        {
+            spawnIndex += entry.second;
+            continue;
+        }
+        instances.clear();
         for (uint8_t n = 0; n < entry.second; ++n)
         {
             vec2 offset = vec2(0.0f, 0.0f);
@@ -481,16 +820,14 @@ spawnParentAsteroidChildren(PtrHandle* ptrHandle,
                 childTransform.rot = std::atan2(offset.x, offset.y);
             }
 
-            objb::AsteroidRecipe rec2(entry.first);
             // todo: add natural rotation, but first setup global random
             // generator
-            rec2.spawn({.ptrHandle = ptrHandle,
-                        .sector = sector,
-                        .pos = childTransform.pos,
-                        .rot = childTransform.rot,
-                        .naturalRot = 0.0f});
+            instances.push_back({.pos = childTransform.pos,
+                                 .rot = childTransform.rot,
+                                 .naturalRot = 0.0f});
             ++spawnIndex;
         }
+        recipe->spawnBatch(ptrHandle, sector, instances);
     }
 }
 
@@ -506,12 +843,13 @@ void damageAndMine(ecs::Asteroid& asteroid,
 {
     auto reg = sector->getRegistry()->getRegistry();
     asteroid.damage(ptrHandle,
+                    sector->getRng(),
                     dmg,
                     [sector, reg, ptrHandle, ast, collPos](
                         gobj::ItemHandle handle, uint32_t quantity)
                     {
-                        gobj::Item* item =
-                            ptrHandle->modManager->getItemLib().getItem(handle);
+                        const gobj::Item* item =
+                            ptrHandle->defCache->getItem(handle);
                         if (!item)
                         {
                             return;
@@ -521,9 +859,10 @@ void damageAndMine(ecs::Asteroid& asteroid,
                         reg->get<Transform>(ast);
                         vec2 dir = collPos - astTransform.pos;
                         vec2 vel = glm::normalize(dir) * 20.0f;
-                        vel.x += rand() % 10 - 5;
-                        vel.y += rand() % 10 - 5;    
-                        float rot = (rand() % 360) / 180.0f * M_PIf;
+                        auto& rng = sector->getRng();
+                        vel.x += rng.uniform(-5.0f, 5.0f);
+                        vel.y += rng.uniform(-5.0f, 5.0f);
+                        float rot = rng.uniform(0.0f, 2.0f * M_PIf);
                         sector->spawnItem(opool::Item{
                             .transform = {collPos, rot},
                             .item = handle,
@@ -535,8 +874,8 @@ void damageAndMine(ecs::Asteroid& asteroid,
                     });
     if (asteroid.volume <= 0.0f)
     {
-        auto* asteroidData = ptrHandle->modManager->getAsteroidLib().getItem(
-            gobj::AsteroidHandle(asteroid.asteroidHandle));
+        const gobj::Asteroid* asteroidData =
+            ptrHandle->defCache->getAsteroid(asteroid.asteroidHandle);
         if (asteroidData)
         {
             if (asteroidData->type == gobj::AsteroidType::Parent)
@@ -562,8 +901,8 @@ static bool itemCollision(const ColResolveParams& p)
     {
         return false;
     }
-    auto* itemData =
-        p.ptrHandle->modManager->getItemLib().getItem(item->itemHandle);
+    const gobj::Item* itemData =
+        p.ptrHandle->defCache->getItem(item->itemHandle);
     if (!itemData)
     {
         LG_E("Item data not found");
@@ -625,11 +964,14 @@ void sysCollisionDetectionImpl(world::Sector* sector,
                                PtrHandle* ptrHandle)
 {
     // Query broadphase collisions from aabb tree
-    auto* reg = sector->getRegistry()->getRegistry();
-    sector->broadphaseCollisions.clear();
-    sector->contactInfos.clear();
+    auto* sectorReg = sector->getRegistry();
+    auto* reg = sectorReg->getRegistry();
+    auto* arena = &con::alloc::FrameArena::local();
+    using EntityPair = std::pair<entt::entity, entt::entity>;
+    std::pmr::vector<EntityPair> broadphaseCollisions(arena);
+    std::pmr::vector<ContactInfo> contactInfos(arena);
 
-    for (auto entity : sector->broadphaseQueryEntities)
+    for (auto entity : sector->getBroadphaseQueryEntities())
     {
         if (!reg->valid(entity) || !reg->all_of<Broadphase>(entity))
         {
@@ -642,7 +984,8 @@ void sysCollisionDetectionImpl(world::Sector* sector,
         }
         sector->queryBroadphase(
             broadphase.fatAABB,
-            [sector, entity, reg](const world::BpUserData& data)
+            [&broadphaseCollisions, entity, reg](
+                const world::BpUserData& data)
             {
                 if (data.type == world::BpUserType::Ecs)
                 {
@@ -670,17 +1013,15 @@ void sysCollisionDetectionImpl(world::Sector* sector,
                     {
                         std::swap(lo, hi);
                     }
-                    sector->broadphaseCollisions.push_back({lo, hi});
+                    broadphaseCollisions.push_back({lo, hi});
                 }
             });
     }
-    std::sort(sector->broadphaseCollisions.begin(),
-              sector->broadphaseCollisions.end());
-    sector->broadphaseCollisions.erase(
-        std::unique(sector->broadphaseCollisions.begin(),
-                    sector->broadphaseCollisions.end()),
-        sector->broadphaseCollisions.end());
-    for (const auto& collision : sector->broadphaseCollisions)
+    std::sort(broadphaseCollisions.begin(), broadphaseCollisions.end());
+    broadphaseCollisions.erase(
+        std::unique(broadphaseCollisions.begin(), broadphaseCollisions.end()),
+        broadphaseCollisions.end());
+    for (const auto& collision : broadphaseCollisions)
     {
         if (!reg->valid(collision.first) || !reg->valid(collision.second))
         {
@@ -700,25 +1041,19 @@ void sysCollisionDetectionImpl(world::Sector* sector,
             continue;
         }
 
-        const ecs::EntityId* exceptEntity1 =
-            (ecs::EntityId*)&collider1->exceptEntity;
-        if (*exceptEntity1 != ecs::EntityId::Invalid())
+        if (collider1->exceptEntity != ecs::EntityId::Invalid()
+            && sectorReg->resolve(collider1->exceptEntity,
+                                  collider1->exceptRef)
+                   == collision.second)
         {
-            auto except = ptrHandle->registryMapping->getEntity(*exceptEntity1);
-            if (except && except->entity == collision.second)
-            {
-                continue;
-            }
+            continue;
         }
-        const ecs::EntityId* exceptEntity2 =
-            (ecs::EntityId*)&collider2->exceptEntity;
-        if (*exceptEntity2 != ecs::EntityId::Invalid())
+        if (collider2->exceptEntity != ecs::EntityId::Invalid()
+            && sectorReg->resolve(collider2->exceptEntity,
+                                  collider2->exceptRef)
+                   == collision.first)
         {
-            auto except = ptrHandle->registryMapping->getEntity(*exceptEntity2);
-            if (except && except->entity == collision.first)
-            {
-                continue;
-            }
+            continue;
         }
 
         auto& transform1 = reg->get<Transform>(collision.first);
@@ -726,9 +1061,9 @@ void sysCollisionDetectionImpl(world::Sector* sector,
         auto& transformCache1 = reg->get<TransformCache>(collision.first);
         auto& transformCache2 = reg->get<TransformCache>(collision.second);
         const gobj::Collider* colliderDef1 =
-            collider1->getColliderDef(ptrHandle->colliderLib);
+            ptrHandle->defCache->getCollider(collider1->colliderHandle);
         const gobj::Collider* colliderDef2 =
-            collider2->getColliderDef(ptrHandle->colliderLib);
+            ptrHandle->defCache->getCollider(collider2->colliderHandle);
 
         const std::optional<Contact> contact =
             ::ecs::collideCollidersWorld(*collider1,
@@ -745,7 +1080,7 @@ void sysCollisionDetectionImpl(world::Sector* sector,
                 ptrHandle, sector, *contact, *collider1, *collider2, collision);
             if (!skipContactSolver)
             {
-                sector->contactInfos.push_back(
+                contactInfos.push_back(
                     {*contact,
                      collision.first,
                      collision.second,
@@ -756,7 +1091,7 @@ void sysCollisionDetectionImpl(world::Sector* sector,
     }
     for (int i = 0; i < kContactSolverIterations; ++i)
     {
-        for (const auto& contactInfo : sector->contactInfos)
+        for (const auto& contactInfo : contactInfos)
         {
             auto& contact = contactInfo.contact;
             auto* phy1 = reg->try_get<PhysicsBody>(contactInfo.ent1);
@@ -839,41 +1174,49 @@ void sysCollisionDetectionImpl(world::Sector* sector,
 void sysAnchorFixedImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
     auto* reg = sector->getRegistry()->getRegistry();
-    auto* regMap = ptrHandle->registryMapping;
-    reg->view<EntityId, AnchorFixed, Transform, SectorId>().each(
-        [ptrHandle, sector, regMap, reg](auto entity,
-                                         auto& entityId,
-                                         auto& anchorFixed,
-                                         auto& transform,
-                                         auto& sectorId)
-        {
-            auto parent = regMap->getEntity(anchorFixed.ref);
-            if (parent)
-            {
-                const auto& parentTransform =
-                    reg->get<Transform>(parent->entity);
-                const auto& parentTransformCache =
-                    reg->get<TransformCache>(parent->entity);
-                const auto& parentSectorId =
-                    reg->get<ecs::SectorId>(parent->entity);
-                vec2 anchorFixedPos = smath::rotateVec2(anchorFixed.pos,
-                                                        parentTransformCache.s,
-                                                        parentTransformCache.c);
-                transform.pos = parentTransform.pos + anchorFixedPos;
-                transform.rot = parentTransform.rot + anchorFixed.rot;
-                if (parentSectorId.id != sectorId.id)
-                {
-                    sector->addSectorMoveRequest(
-                        ptrHandle,
-                        world::SectorMoveRequest{entityId, parentSectorId.id});
-                }
-            }
-            else
-            {
-                LG_W("AnchorFixed parent not found for entity {}", entityId);
-                sector->markEntityForDestruction(ptrHandle, entityId);
-            }
-        });
+    const auto& hierarchy = sector->getRegistry()->getAnchorHierarchy();
+    auto& transforms = reg->storage<Transform>();
+    auto& transformCaches = reg->storage<TransformCache>();
+    auto& anchors = reg->storage<AnchorFixed>();
+    auto& entityIds = reg->storage<EntityId>();
+
+    // Parent pose is read once, its children are a contiguous span. Parents
+    // and children here share this registry, a parent that migrated shows
+    // up in the detached list below instead.
+    for (const auto& parent : hierarchy.getParents())
+    {
+        const auto& parentTransform = transforms.get(parent.entity);
+        const auto& parentTransformCache = transformCaches.get(parent.entity);
+        for (auto child : hierarchy.getChildren(parent))
+        {
+            const auto& anchorFixed = anchors.get(child);
+            auto& transform = transforms.get(child);
+            vec2 anchorFixedPos = smath::rotateVec2(anchorFixed.pos,
+                                                    parentTransformCache.s,
+                                                    parentTransformCache.c);
+            transform.pos = parentTransform.pos + anchorFixedPos;
+            transform.rot = parentTransform.rot + anchorFixed.rot;
+        }
+    }
+
+    // Children left behind by a migrated parent follow it, orphans are
+    // destroyed. Both leave the registry at the barrier, which dirties the
+    // hierarchy again.
+    for (const auto& detached : hierarchy.getDetached())
+    {
+        const auto& entityId = entityIds.get(detached.entity);
+        if (detached.parentSectorId != world::INVALID_SECTOR_ID)
+        {
+            sector->addSectorMoveRequest(
+                ptrHandle,
+                world::SectorMoveRequest{entityId, detached.parentSectorId});
+        }
+        else
+        {
+            LG_W("AnchorFixed parent not found for entity {}", entityId);
+            sector->markEntityForDestruction(ptrHandle, entityId);
+        }
+    }
 }
 
 }  // namespace ecs
@@ -16,6 +16,15 @@ const System sysMoveCtrl = {.name = "sysMoveCtrl",
                             .sysFlags = SystemFlags::ActiveSector,
                             .function = sysMoveCtrlImpl};
 
+// Local avoidance for ships under MoveCtrl::MoveMode::MoveTo. Bends the
+// desired velocity of sysMoveCtrl around the neighbours found with one
+// broadphase query per ship, before sysPhyThrust applies the thrust.
+void sysAvoidanceImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle);
+
+const System sysAvoidance = {.name = "sysAvoidance",
+                             .sysFlags = SystemFlags::ActiveSector,
+                             .function = sysAvoidanceImpl};
+
 void sysPhyThrustImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle);
 
 const System sysPhyThrust = {.name = "sysPhyThrust",
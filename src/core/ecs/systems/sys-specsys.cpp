@@ -5,6 +5,8 @@
 #include "sector.hpp"
 #include "std-inc.hpp"
 #include "sys-phy.hpp"
+#include <def-cache.hpp>
+#include <frame-arena.hpp>
 #include <lib-collider.hpp>
 #include <mod-manager.hpp>
 #include <sys-specsys.hpp>
@@ -44,97 +46,102 @@ static inline void projColliderAction(PtrHandle* ptrHandle,
 
 void sysProjPhysicsImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
-    sector->foreachProj(
-        [ptrHandle, dt, sector](opool::Projectile& projectile,
-                                opool::ProjectileHandle handle)
-        {
-            // LIFETIME
-            projectile.lifetime += dt;
-            if (projectile.lifetime > projectile.lifetimeMax)
-            {
-                return con::FreeVecForeachRet::DESTROY;
-            }
-
-            // MOVEMENT
-            auto& ws = ptrHandle->world->getWorldShape();
-            auto& trans = projectile.transform;
-            trans.pos += projectile.vel * dt;
+    auto& store = sector->getProjectileStore();
+    if (store.size() == 0)
+    {
+        return;
+    }
 
-            const float ws2 = ws.sectorSize / 2.0f;
-            if (trans.pos.x < -ws2 || trans.pos.x > ws2 || trans.pos.y < -ws2
-                || trans.pos.y > ws2)
+    // LIFETIME + MOVEMENT, expired and out of sector projectiles are compacted
+    // away so the broadphase only sees survivors
+    const float ws2 = ptrHandle->world->getWorldShape().sectorSize / 2.0f;
+    store.integrate(dt, ws2);
+
+    // COLLISION
+    auto* sectorReg = sector->getRegistry();
+    auto reg = sectorReg->getRegistry();
+    const mod::DefCache* defCache = ptrHandle->defCache;
+    // Projectiles of one turret are spawned back to back, so resolving the
+    // except entity only on change skips almost all lookups. The handle
+    // cached per projectile keeps the rest off the global mapping.
+    EntityId lastExcept = EntityId::Invalid();
+    entt::entity exceptEntity = entt::null;
+    // World space collider vertices, shared by all point tests of the pass
+    std::pmr::vector<vec2> w1(&con::alloc::FrameArena::local());
+    const uint32_t count = store.size();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const EntityId& collExcept = store.getCollExcept(i);
+        if (collExcept != lastExcept)
+        {
+            lastExcept = collExcept;
+            exceptEntity =
+                sectorReg->resolve(collExcept, store.getCollExceptRef(i));
+        }
+        const vec2 pos = store.getPos(i);
+        bool hit = false;
+        sector->queryBroadphasePoint(
+            pos,
+            [&](const world::BpUserData& data)
             {
-                return con::FreeVecForeachRet::DESTROY;
-            }
-
-            // COLLISION
-            auto slot =
-                ptrHandle->registryMapping->getEntity(projectile.collExcept);
-            auto ret = con::FreeVecForeachRet::OK;
-            sector->queryBroadphasePoint(
-                trans.pos,
-                [slot, sector, &ret, ptrHandle, &trans, &projectile](
-                    const world::BpUserData& data)
+                if (data.type != world::BpUserType::Ecs)
+                {
+                    return;
+                }
+                auto other = data.data.ent;
+                if (other == exceptEntity)
+                {
+                    return;
+                }
+                auto coll = reg->try_get<ecs::Collider>(other);
+                auto tr = reg->try_get<ecs::Transform>(other);
+                auto trc = reg->try_get<ecs::TransformCache>(other);
+                if (coll && tr && trc)
                 {
-                    if (data.type == world::BpUserType::Ecs)
+                    const gobj::Collider* collItem =
+                        defCache->getCollider(coll->colliderHandle);
+                    if (!collItem)
                     {
-                        auto other = data.data.ent;
-                        if (slot && other == slot->entity
-                            && slot->sectorId == sector->getId())
-                        {
-                            return;
-                        }
-                        auto reg = sector->getRegistry()->getRegistry();
-                        auto coll = reg->try_get<ecs::Collider>(other);
-                        auto tr = reg->try_get<ecs::Transform>(other);
-                        auto trc = reg->try_get<ecs::TransformCache>(other);
+                        return;
+                    }
 
-                        if (coll && tr && trc)
+                    const auto v1 = &collItem->vertices;
+                    const size_t n1 = v1->size();
+                    w1.resize(n1);
+                    for (size_t k = 0; k < n1; ++k)
+                    {
+                        const vec2& v = (*v1)[k];
+                        w1[k].x = trc->c * v.x - trc->s * v.y + tr->pos.x;
+                        w1[k].y = trc->s * v.x + trc->c * v.y + tr->pos.y;
+                    }
+                    if (sat2d::pointInConvex(pos, w1))
+                    {
+                        const gobj::Projectile* projData =
+                            defCache->getProjectile(store.getProj(i));
+                        if (projData)
                         {
-                            auto collItem =
-                                ptrHandle->modManager->getColliderLib().getItem(
-                                    coll->colliderHandle);
-
-                            const auto v1 = &collItem->vertices;
-                            const size_t n1 = v1->size();
-                            thread_local std::vector<vec2> w1;
-                            w1.resize(v1->size());
-                            for (size_t i = 0; i < n1; ++i)
-                            {
-                                const vec2& v = (*v1)[i];
-                                w1[i].x =
-                                    trc->c * v.x - trc->s * v.y + tr->pos.x;
-                                w1[i].y =
-                                    trc->s * v.x + trc->c * v.y + tr->pos.y;
-                            }
-                            if (sat2d::pointInConvex(trans.pos, w1))
-                            {
-                                auto projData =
-                                    ptrHandle->modManager->getProjectileLib()
-                                        .getItem(projectile.proj);
-                                if (projData)
-                                {
-                                    projColliderAction(
-                                        ptrHandle,
-                                        sector,
-                                        coll->colliderType,
-                                        other,
-                                        *projData,
-                                        projectile.transform.pos);
-                                }
-                                ret = con::FreeVecForeachRet::DESTROY;
-                            }
+                            projColliderAction(ptrHandle,
+                                               sector,
+                                               coll->colliderType,
+                                               other,
+                                               *projData,
+                                               pos);
                         }
+                        hit = true;
                     }
-                });
-
-            return ret;
-        });
+                }
+            });
+        if (hit)
+        {
+            store.kill(i);
+        }
+    }
+    store.compact();
 }
 
 void sysItemPhysicsImpl(world::Sector* sector, float dt, PtrHandle* ptrHandle)
 {
-    sector->foreachItem(
+    sector->forEachItem(
         [ptrHandle, dt, sector](opool::Item& item, opool::ItemHandle handle)
         {
             // LIFETIME
@@ -1,12 +1,22 @@
 #include "sys-turret.hpp"
 #include "comp-phy.hpp"
+#include "comp-tag.hpp"
+#include "frame-arena.hpp"
 #include "lib-projectile.hpp"
+#include <def-cache.hpp>
 #include <engine.hpp>
 
 namespace ecs
 {
 
 constexpr float kAngleErrorThreshold = 2.0f * M_PIf / 180.0f;
+// Auto targeting: frames between retargets and the score weights, see
+// scoreCandidate()
+constexpr uint32_t kRetargetInterval = 30;
+constexpr float kRetargetAngleWeight = 0.5f;
+constexpr float kRetargetThreatWeight = 0.5f;
+constexpr float kRetargetThreatSpd = 100.0f;
+constexpr float kRetargetKeepBonus = 0.25f;
 
 static inline float aimToTarget(const Transform& trSelf, const vec2& tgtPos)
 {
@@ -16,7 +26,7 @@ static inline float aimToTarget(const Transform& trSelf, const vec2& tgtPos)
     return tgtAngle;
 }
 
-static inline float gotoAngle(gobj::mdata::Turret& libTurretData,
+static inline float gotoAngle(const gobj::mdata::Turret& libTurretData,
                               float& currentAngle,
                               float tgtAngle,
                               float dt)
@@ -26,23 +36,231 @@ static inline float gotoAngle(gobj::mdata::Turret& libTurretData,
     return currentAngle + std::clamp(delta, -maxStep, maxStep);
 }
 
-void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
+namespace
+{
+
+struct AutoTurret
+{
+    EntityId parent;
+    entt::entity entity;
+};
+
+struct TargetCandidate
+{
+    entt::entity entity;
+    EntityId entityId;
+    vec2 pos;
+    vec2 vel;
+    Turret::TargetFilter kind;
+};
+
+// Lower is better, out of range candidates score float max
+inline float scoreCandidate(const Transform& trSelf,
+                            const Turret& turret,
+                            float range,
+                            const TargetCandidate& candidate)
+{
+    const vec2 dir = candidate.pos - trSelf.pos;
+    const float dist = glm::length(dir);
+    if (dist > range)
+    {
+        return std::numeric_limits<float>::max();
+    }
+    // Distance and the angle the turret still has to turn dominate, closing
+    // targets are preferred and the current target gets a bonus so turrets
+    // do not flicker between equal candidates
+    const float angleError = fabsf(smath::angleError(
+        aimToTarget(trSelf, candidate.pos), turret.currentAngle));
+    float score = dist / range + kRetargetAngleWeight * angleError / M_PIf;
+    if (dist > 1e-4f)
+    {
+        const float closingSpd = -glm::dot(candidate.vel, dir / dist);
+        score -= kRetargetThreatWeight
+                 * std::clamp(closingSpd / kRetargetThreatSpd, 0.0f, 1.0f);
+    }
+    if (candidate.entity == turret.target.entity)
+    {
+        score -= kRetargetKeepBonus;
+    }
+    return score;
+}
+
+}  // namespace
+
+void sysTurretTargetImpl(world::Sector* sector,
+                         const float dt,
+                         PtrHandle* ptrHandle)
 {
     auto* reg = sector->getRegistry()->getRegistry();
+    auto& arena = con::alloc::FrameArena::local();
+
+    // Turrets of one ship retarget together and share one broadphase query,
+    // ships are spread over the interval by their id
+    std::pmr::vector<AutoTurret> due(&arena);
+    const uint32_t frame = ptrHandle->frameCnt;
+    reg->view<Turret, Module>().each(
+        [&due, frame](auto entity, auto& turret, auto& module)
+        {
+            if (turret.autoTarget != Turret::TargetFilter::None
+                && (frame + module.parent.index) % kRetargetInterval == 0)
+            {
+                due.push_back({module.parent, entity});
+            }
+        });
+    if (due.empty())
+    {
+        return;
+    }
+    std::sort(due.begin(),
+              due.end(),
+              [](const AutoTurret& a, const AutoTurret& b)
+              { return a.parent.index < b.parent.index; });
+
+    auto& turrets = reg->storage<Turret>();
+    auto& modules = reg->storage<Module>();
+    auto& transforms = reg->storage<Transform>();
+    const auto& entityIds = reg->storage<EntityId>();
+    const auto& asteroids = reg->storage<Asteroid>();
+    const auto& ships = reg->storage<tag::obj::Ship>();
+    const auto& bodies = reg->storage<PhysicsBody>();
+    std::pmr::vector<TargetCandidate> candidates(&arena);
+    size_t runStart = 0;
+    while (runStart < due.size())
+    {
+        const EntityId parent = due[runStart].parent;
+        size_t runEnd = runStart;
+        bool wantAsteroids = false, wantShips = false;
+        con::AABB queryBox{vec2(std::numeric_limits<float>::max()),
+                           vec2(std::numeric_limits<float>::lowest())};
+        for (; runEnd < due.size() && due[runEnd].parent == parent; ++runEnd)
+        {
+            const entt::entity entity = due[runEnd].entity;
+            mod::DefCache::TurretDef fallbackDef;
+            const auto* turretDef = ptrHandle->defCache->getTurret(
+                modules.get(entity).moduleHandle, fallbackDef);
+            if (!turretDef || !transforms.contains(entity))
+            {
+                continue;
+            }
+            const float range = turretDef->turret->range;
+            const vec2 pos = transforms.get(entity).pos;
+            queryBox.lower = glm::min(queryBox.lower, pos - range);
+            queryBox.upper = glm::max(queryBox.upper, pos + range);
+            const auto filter = turrets.get(entity).autoTarget;
+            wantAsteroids |= filter == Turret::TargetFilter::Asteroids;
+            wantShips |= filter == Turret::TargetFilter::Ships;
+        }
+        if (queryBox.lower.x > queryBox.upper.x)
+        {
+            runStart = runEnd;
+            continue;
+        }
+
+        candidates.clear();
+        sector->queryBroadphase(
+            queryBox,
+            [&](const world::BpUserData& data)
+            {
+                if (data.type != world::BpUserType::Ecs)
+                {
+                    return;
+                }
+                const entt::entity other = data.data.ent;
+                if (!entityIds.contains(other) || !transforms.contains(other))
+                {
+                    return;
+                }
+                Turret::TargetFilter kind;
+                if (wantAsteroids && asteroids.contains(other))
+                {
+                    kind = Turret::TargetFilter::Asteroids;
+                }
+                else if (wantShips && ships.contains(other))
+                {
+                    kind = Turret::TargetFilter::Ships;
+                }
+                else
+                {
+                    return;
+                }
+                const EntityId& otherId = entityIds.get(other);
+                if (otherId == parent)
+                {
+                    return;
+                }
+                candidates.push_back(
+                    {other,
+                     otherId,
+                     transforms.get(other).pos,
+                     bodies.contains(other) ? bodies.get(other).vel
+                                            : vec2(0.0f),
+                     kind});
+            });
+
+        for (size_t i = runStart; i < runEnd; ++i)
+        {
+            const entt::entity entity = due[i].entity;
+            auto& turret = turrets.get(entity);
+            mod::DefCache::TurretDef fallbackDef;
+            const auto* turretDef = ptrHandle->defCache->getTurret(
+                modules.get(entity).moduleHandle, fallbackDef);
+            if (!turretDef || !transforms.contains(entity))
+            {
+                continue;
+            }
+            const Transform& transform = transforms.get(entity);
+            const TargetCandidate* best = nullptr;
+            float bestScore = std::numeric_limits<float>::max();
+            for (const auto& candidate : candidates)
+            {
+                if (candidate.kind != turret.autoTarget)
+                {
+                    continue;
+                }
+                const float score = scoreCandidate(
+                    transform, turret, turretDef->turret->range, candidate);
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    best = &candidate;
+                }
+            }
+            if (best)
+            {
+                turret.aimMode = Turret::AimMode::Entity;
+                turret.aimData = Turret::EntityData{best->entityId};
+                turret.fireMode = Turret::FireMode::AutoAngle;
+                turret.target = LocalRef{best->entity, sector->getId()};
+            }
+            else
+            {
+                turret.setAimMode(Turret::AimMode::None);
+                turret.fireMode = Turret::FireMode::None;
+                turret.target = LocalRef{};
+            }
+        }
+        runStart = runEnd;
+    }
+}
+
+void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
+{
+    auto* sectorReg = sector->getRegistry();
+    auto* reg = sectorReg->getRegistry();
     reg->view<Turret, Module, Transform, SectorId>().each(
-        [ptrHandle, dt, reg, sector](auto entity,
-                                     auto& turret,
-                                     auto& module,
-                                     auto& transform,
-                                     auto& sectorId)
+        [ptrHandle, dt, reg, sectorReg, sector](auto entity,
+                                                auto& turret,
+                                                auto& module,
+                                                auto& transform,
+                                                auto& sectorId)
         {
-            gobj::ModuleHandle moduleHandle = module.moduleHandle;
-            gobj::Module* moduleItem =
-                ptrHandle->modManager->getModuleLib().getItem(moduleHandle);
-            if (moduleItem && moduleItem->type == gobj::ModuleType::Turret)
+            mod::DefCache::TurretDef fallbackDef;
+            const mod::DefCache::TurretDef* turretDef =
+                ptrHandle->defCache->getTurret(module.moduleHandle,
+                                               fallbackDef);
+            if (turretDef)
             {
-                gobj::mdata::Turret libTurretData =
-                    std::get<gobj::mdata::Turret>(moduleItem->data);
+                const gobj::mdata::Turret& libTurretData = *turretDef->turret;
                 // Turret rotation
                 switch (turret.aimMode)
                 {
@@ -68,18 +286,15 @@ void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
                     {
                         Turret::EntityData& entityData =
                             std::get<Turret::EntityData>(turret.aimData);
-                        auto slot = ptrHandle->registryMapping->getEntity(
-                            entityData.entityId);
-                        if (!slot)
+                        const entt::entity target = sectorReg->resolve(
+                            entityData.entityId, turret.target);
+                        if (target == entt::null)
                         {
                             turret.aimMode = Turret::AimMode::None;
                             turret.fireMode = Turret::FireMode::None;
                             return;
                         }
-                        auto* trTgt =
-                            sector->getRegistry()
-                                ->getRegistry()
-                                ->try_get<ecs::Transform>(slot->entity);
+                        auto* trTgt = reg->try_get<ecs::Transform>(target);
                         if (trTgt)
                         {
                             const vec2 tgtPos = trTgt->pos;
@@ -112,9 +327,12 @@ void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
                 {
                     case def::TurretType::Projectile:
                     {
-                        gobj::mdata::Turret::ProjectileData& projectileData =
-                            std::get<gobj::mdata::Turret::ProjectileData>(
-                                libTurretData.data);
+                        if (!turretDef->projectileData)
+                        {
+                            break;
+                        }
+                        const gobj::mdata::Turret::ProjectileData&
+                            projectileData = *turretDef->projectileData;
                         Turret::ProjectileData& ballisticData =
                             std::get<Turret::ProjectileData>(turret.data);
                         if (ballisticData.reloadTimer > 0.0f)
@@ -125,8 +343,7 @@ void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
                                  && turret.isFiring)
                         {
                             const gobj::Projectile* proj =
-                                ptrHandle->modManager->getProjectileLib()
-                                    .getItem(projectileData.projectile);
+                                turretDef->projectile;
                             if(!proj)
                             {
                                 break;
@@ -141,12 +358,12 @@ void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
                                 libTurretData.barrelExits[0], s, c);
 
                             vec2 parVel = vec2(0.0f, 0.0f);
-                            auto slot = ptrHandle->registryMapping->getEntity(
-                                module.parent);
-                            if (slot)
+                            const entt::entity parent = sectorReg->resolve(
+                                module.parent, module.parentRef);
+                            if (parent != entt::null)
                             {
                                 auto* physBody =
-                                    reg->try_get<PhysicsBody>(slot->entity);
+                                    reg->try_get<PhysicsBody>(parent);
                                 if (physBody)
                                 {
                                     parVel = physBody->vel;
@@ -158,6 +375,7 @@ void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle)
                             sector->spawnProjectile(opool::Projectile{
                                 .transform = ecs::Transform{transform.pos + exit, firingRot},
                                 .collExcept = module.parent,
+                                .collExceptRef = module.parentRef,
                                 .proj = projectileData.projectile,
                                 .vel = parVel + fireVel,
                                 .lifetimeMax = proj->lifetime
@@ -9,8 +9,17 @@
 namespace ecs
 {
 
+void sysTurretTargetImpl(world::Sector* sector,
+                         const float dt,
+                         PtrHandle* ptrHandle);
 void sysTurretImpl(world::Sector* sector, const float dt, PtrHandle* ptrHandle);
 
+// Picks targets for turrets with Turret::autoTarget set, one broadphase
+// query per ship on a fixed cadence
+const System sysTurretTarget = {.name = "sysTurretTarget",
+                                .sysFlags = SystemFlags::ActiveSector,
+                                .function = sysTurretTargetImpl};
+
 const System sysTurret = {.name = "sysTurret",
                           .sysFlags = SystemFlags::ActiveSector,
                           .function = sysTurretImpl};
@@ -0,0 +1,186 @@
+#include <def-cache.hpp>
+#include <mod-manager.hpp>
+#ifdef SERVER
+#include <objb-recipes.hpp>
+#endif
+
+namespace mod
+{
+
+DefCache::DefCache() = default;
+DefCache::~DefCache() = default;
+
+void DefCache::build(ModManager& modManager)
+{
+    this->modManager = &modManager;
+    buildTable(modManager.getColliderLib(), colliders);
+    buildTable(modManager.getProjectileLib(), projectiles);
+    buildTable(modManager.getAsteroidLib(), asteroids);
+    buildTable(modManager.getItemLib(), items);
+    buildTable(modManager.getModuleLib(), modules);
+
+    turrets.clear();
+    turrets.resize(modules.size());
+    int numTurrets = 0;
+    for (size_t i = 0; i < modules.size(); i++)
+    {
+        if (!modules[i].def)
+        {
+            continue;
+        }
+        const gobj::ModuleHandle handle(i, modules[i].generation);
+        if (resolveTurret(modManager, handle, turrets[i].def))
+        {
+            turrets[i].generation = modules[i].generation;
+            numTurrets++;
+        }
+    }
+    LG_I("Definition cache built: {} colliders, {} modules ({} turrets), {} "
+         "asteroids, {} items, {} projectiles",
+         colliders.size(),
+         modules.size(),
+         numTurrets,
+         asteroids.size(),
+         items.size(),
+         projectiles.size());
+}
+
+#ifdef SERVER
+void DefCache::buildRecipes(ecs::PtrHandle* ptrHandle)
+{
+    asteroidRecipes.clear();
+    asteroidRecipes.resize(asteroids.size());
+    int numRecipes = 0;
+    for (size_t i = 0; i < asteroids.size(); i++)
+    {
+        if (!asteroids[i].def)
+        {
+            continue;
+        }
+        const gobj::AsteroidHandle handle(i, asteroids[i].generation);
+        auto recipe = std::make_unique<objb::AsteroidRecipe>(handle);
+        if (recipe->compile(ptrHandle))
+        {
+            asteroidRecipes[i].def = std::move(recipe);
+            asteroidRecipes[i].generation = asteroids[i].generation;
+            numRecipes++;
+        }
+    }
+    LG_I("Compiled {} asteroid recipes", numRecipes);
+}
+#endif
+
+bool DefCache::validate() const
+{
+    if (!modManager)
+    {
+        return false;
+    }
+    return validateTable(modManager->getColliderLib(), colliders)
+           && validateTable(modManager->getProjectileLib(), projectiles)
+           && validateTable(modManager->getAsteroidLib(), asteroids)
+           && validateTable(modManager->getItemLib(), items)
+           && validateTable(modManager->getModuleLib(), modules);
+}
+
+const gobj::Collider* DefCache::getCollider(gobj::ColliderHandle handle) const
+{
+    auto* def = lookup(colliders, handle.getIdx(), handle.getGeneration());
+    if (def)
+    {
+        return *def;
+    }
+    return modManager ? modManager->getColliderLib().getItem(handle) : nullptr;
+}
+
+const gobj::Projectile*
+DefCache::getProjectile(gobj::ProjectileHandle handle) const
+{
+    auto* def = lookup(projectiles, handle.getIdx(), handle.getGeneration());
+    if (def)
+    {
+        return *def;
+    }
+    return modManager ? modManager->getProjectileLib().getItem(handle)
+                      : nullptr;
+}
+
+const gobj::Asteroid* DefCache::getAsteroid(gobj::AsteroidHandle handle) const
+{
+    auto* def = lookup(asteroids, handle.getIdx(), handle.getGeneration());
+    if (def)
+    {
+        return *def;
+    }
+    return modManager ? modManager->getAsteroidLib().getItem(handle) : nullptr;
+}
+
+const gobj::Item* DefCache::getItem(gobj::ItemHandle handle) const
+{
+    auto* def = lookup(items, handle.getIdx(), handle.getGeneration());
+    if (def)
+    {
+        return *def;
+    }
+    return modManager ? modManager->getItemLib().getItem(handle) : nullptr;
+}
+
+#ifdef SERVER
+objb::AsteroidRecipe*
+DefCache::getAsteroidRecipe(gobj::AsteroidHandle handle) const
+{
+    auto* def =
+        lookup(asteroidRecipes, handle.getIdx(), handle.getGeneration());
+    return def ? def->get() : nullptr;
+}
+#endif
+
+const DefCache::TurretDef* DefCache::getTurret(gobj::ModuleHandle handle,
+                                               TurretDef& fallback) const
+{
+    auto* def = lookup(turrets, handle.getIdx(), handle.getGeneration());
+    if (def)
+    {
+        return def;
+    }
+    // Known module that is no turret
+    if (lookup(modules, handle.getIdx(), handle.getGeneration()))
+    {
+        return nullptr;
+    }
+    if (modManager && resolveTurret(*modManager, handle, fallback))
+    {
+        return &fallback;
+    }
+    return nullptr;
+}
+
+bool DefCache::resolveTurret(ModManager& modManager,
+                             gobj::ModuleHandle handle,
+                             TurretDef& turretDef)
+{
+    const gobj::Module* module = modManager.getModuleLib().getItem(handle);
+    if (!module || module->type != gobj::ModuleType::Turret)
+    {
+        return false;
+    }
+    const auto* turret = std::get_if<gobj::mdata::Turret>(&module->data);
+    if (!turret)
+    {
+        return false;
+    }
+    turretDef = TurretDef{.module = module, .turret = turret};
+    if (turret->type == def::TurretType::Projectile)
+    {
+        turretDef.projectileData =
+            std::get_if<gobj::mdata::Turret::ProjectileData>(&turret->data);
+        if (turretDef.projectileData)
+        {
+            turretDef.projectile = modManager.getProjectileLib().getItem(
+                turretDef.projectileData->projectile);
+        }
+    }
+    return true;
+}
+
+}  // namespace mod
@@ -0,0 +1,146 @@
+#ifndef DEF_CACHE_HPP
+#define DEF_CACHE_HPP
+
+#include <item-lib.hpp>
+#include <lib-asteroid.hpp>
+#include <lib-collider.hpp>
+#include <lib-item.hpp>
+#include <lib-modules.hpp>
+#include <lib-projectile.hpp>
+#include <memory>
+#include <std-inc.hpp>
+
+#ifdef SERVER
+namespace ecs
+{
+struct PtrHandle;
+}
+namespace objb
+{
+class AsteroidRecipe;
+}
+#endif
+
+namespace mod
+{
+
+class ModManager;
+
+// Frozen, flattened view of the game libraries for the hot systems. Built
+// after the mods are loaded, indexed by handle index and checked against the
+// handle generation, so a lookup is a bounds check and a compare. Variant
+// data (e.g. turret module data) is resolved once at build time instead of
+// per tick. Handles the cache does not know fall back to the library.
+class DefCache
+{
+  public:
+    struct TurretDef
+    {
+        const gobj::Module* module = nullptr;
+        const gobj::mdata::Turret* turret = nullptr;
+        // Only set for def::TurretType::Projectile
+        const gobj::mdata::Turret::ProjectileData* projectileData = nullptr;
+        const gobj::Projectile* projectile = nullptr;
+    };
+
+    DefCache();
+    ~DefCache();
+
+    // Rebuilds all tables from the libraries. Pointers handed out before are
+    // invalid afterwards, must only be called while no system runs.
+    void build(ModManager& modManager);
+#ifdef SERVER
+    // Compiles one spawn recipe per asteroid definition, same rules as
+    // build(). Needs the asset factory of ptrHandle.
+    void buildRecipes(ecs::PtrHandle* ptrHandle);
+#endif
+    // False if any library changed since build(), e.g. after a hot reload
+    bool validate() const;
+
+    const gobj::Collider* getCollider(gobj::ColliderHandle handle) const;
+    const gobj::Projectile* getProjectile(gobj::ProjectileHandle handle) const;
+    const gobj::Asteroid* getAsteroid(gobj::AsteroidHandle handle) const;
+    const gobj::Item* getItem(gobj::ItemHandle handle) const;
+#ifdef SERVER
+    // Compiled recipe, nullptr if the handle is unknown or its prototype
+    // failed to build. Spawning from it only reads the prototype, so sector
+    // workers can share it.
+    objb::AsteroidRecipe* getAsteroidRecipe(gobj::AsteroidHandle handle) const;
+#endif
+    // Returns nullptr if the module is not a turret. On a cache miss the
+    // definition is resolved into fallback.
+    const TurretDef* getTurret(gobj::ModuleHandle handle,
+                               TurretDef& fallback) const;
+
+    static bool resolveTurret(ModManager& modManager,
+                              gobj::ModuleHandle handle,
+                              TurretDef& turretDef);
+
+  private:
+    template <class T> struct Slot
+    {
+        T def{};
+        uint16_t generation = 0;
+    };
+
+    template <class T>
+    static const T* lookup(const std::vector<Slot<T>>& table,
+                           uint16_t idx,
+                           uint16_t generation)
+    {
+        if (generation == 0 || idx >= table.size()
+            || table[idx].generation != generation)
+        {
+            return nullptr;
+        }
+        return &table[idx].def;
+    }
+
+    template <class T>
+    static void buildTable(con::ItemLib<T>& lib,
+                           std::vector<Slot<const T*>>& table)
+    {
+        table.clear();
+        table.resize(lib.size());
+        for (int i = 0; i < lib.size(); i++)
+        {
+            table[i].def = lib.getItem(i);
+            table[i].generation = table[i].def ? lib.getGeneration(i) : 0;
+        }
+    }
+
+    template <class T>
+    static bool validateTable(con::ItemLib<T>& lib,
+                              const std::vector<Slot<const T*>>& table)
+    {
+        if (lib.size() != table.size())
+        {
+            return false;
+        }
+        for (int i = 0; i < lib.size(); i++)
+        {
+            const T* item = lib.getItem(i);
+            if (table[i].def != item
+                || (item && table[i].generation != lib.getGeneration(i)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ModManager* modManager = nullptr;
+    std::vector<Slot<const gobj::Collider*>> colliders;
+    std::vector<Slot<const gobj::Projectile*>> projectiles;
+    std::vector<Slot<const gobj::Asteroid*>> asteroids;
+    std::vector<Slot<const gobj::Item*>> items;
+    std::vector<Slot<const gobj::Module*>> modules;
+    std::vector<Slot<TurretDef>> turrets;
+#ifdef SERVER
+    std::vector<Slot<std::unique_ptr<objb::AsteroidRecipe>>> asteroidRecipes;
+#endif
+};
+
+}  // namespace mod
+
+#endif
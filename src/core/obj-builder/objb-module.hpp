@@ -62,7 +62,28 @@ struct Module
         auto hullSlot = hullItem->slots[slotIndex];
         OBJB_GUARD(hullSlot.type == module->slotType,
                    "Could not spawn module. Incompatible slot type")
-        OBJB_GUARD(Textures::build(ptrHandle, params, module->textures),
+        OBJB_GUARD(
+            buildParts(
+                ptrHandle, params, parent, moduleHandle, *module, hullSlot),
+            "")
+        hull->addModule(
+            slotIndex,
+            ecs::ModuleRef{params.entityId, module->type, module->slotType});
+        return true;
+    }
+
+    // Everything of a module that does not depend on the parent entity
+    // besides the references to it. Used by Module::build and by recipe
+    // prototypes, which patch the references per instance
+    static bool buildParts(ecs::PtrHandle* ptrHandle,
+                           ecs::SpawnCallbackParams& params,
+                           ecs::EntityId parent,
+                           const gobj::ModuleHandle& moduleHandle,
+                           const gobj::Module& module,
+                           const gobj::ModuleSlot& hullSlot)
+    {
+        auto& reg = params.reg;
+        OBJB_GUARD(Textures::build(ptrHandle, params, module.textures),
                    "Failed to build module texture")
         OBJB_GUARD(Transform::build(ptrHandle, params), "");
         OBJB_GUARD(AnchorFixed::build(ptrHandle,
@@ -71,12 +92,12 @@ struct Module
                                                        .rot = hullSlot.rot,
                                                        .ref = parent}),
                    "Failed to build module anchor")
-        reg->emplace_or_replace<ecs::Module>(
+        reg.emplace_or_replace<ecs::Module>(
             params.entity,
             ecs::Module{moduleHandle.toGenericHandle(),
                         parent.toGenericHandle32()});
 
-        switch (module->type)
+        switch (module.type)
         {
             case gobj::ModuleType::MainThruster:
                 break;
@@ -89,7 +110,7 @@ struct Module
                 OBJB_GUARD(
                     Turret::build(ptrHandle,
                                   params,
-                                  std::get<gobj::mdata::Turret>(module->data),
+                                  std::get<gobj::mdata::Turret>(module.data),
                                   parent),
                     "");
                 OBJB_GUARD(Ai::build(ptrHandle,
@@ -103,9 +124,6 @@ struct Module
             default:
                 break;
         }
-        hull->addModule(
-            slotIndex,
-            ecs::ModuleRef{params.entityId, module->type, module->slotType});
         return true;
     }
 };
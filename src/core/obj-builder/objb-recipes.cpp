@@ -1,64 +1,282 @@
 #include "comp-ident.hpp"
 #include "logging.hpp"
+#include "objb-asteroid.hpp"
 #include "objb-general.hpp"
+#include "objb-module.hpp"
 #include "objb-ship.hpp"
 #include "ptr-handle.hpp"
+#include <asset-factory.hpp>
 #include <engine.hpp>
+#include <frame-arena.hpp>
 #include <mod-manager.hpp>
 #include <objb-recipes.hpp>
 
 namespace objb
 {
 
-ecs::EntityId ShipRecipe::spawn(const RecipeSpawnParams& params)
+namespace
+{
+
+void placeInstances(entt::registry* reg,
+                    std::span<const entt::entity> entities,
+                    std::span<const RecipeInstance> instances)
 {
-    auto ptr = params.ptrHandle;
+    auto& transforms = reg->storage<ecs::Transform>();
+    auto& transformCaches = reg->storage<ecs::TransformCache>();
+    auto& bodies = reg->storage<ecs::PhysicsBody>();
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        const entt::entity entity = entities[i];
+        const RecipeInstance& instance = instances[i];
+        auto& transform = transforms.get(entity);
+        transform.pos = instance.pos;
+        transform.rot = instance.rot;
+        auto& transCache = transformCaches.get(entity);
+        transCache.c = cosf(instance.rot);
+        transCache.s = sinf(instance.rot);
+        if (bodies.contains(entity))
+        {
+            auto& body = bodies.get(entity);
+            body.vel = instance.vel;
+            body.naturalRotation = instance.naturalRot;
+        }
+    }
+}
+
+}  // namespace
+
+void RecipePrototype::stamp(ecs::PtrHandle* ptrHandle,
+                            entt::entity prototype,
+                            world::Sector* sector,
+                            std::span<const entt::entity> entities)
+{
+    // Only reads the prototype registry, the const view does not create
+    // missing pools, so compiled recipes can be shared by the sector workers
+    const entt::registry& srcReg = reg;
+    auto* dstReg = sector->getRegistry()->getRegistry();
+    const auto& componentFactory = ptrHandle->assetFactory->componentFactory;
+    for (auto [storageId, storage] : srcReg.storage())
+    {
+        const auto* helper = componentFactory.getHelperByStorage(storageId);
+        if (helper && storage.contains(prototype))
+        {
+            helper->prototypeInserter(srcReg, prototype, *dstReg, entities);
+        }
+    }
+
+    // The stamped handle points into the prototype task system, every
+    // instance gets its own copy of the stack in the sector
+    const auto* ai = srcReg.try_get<ecs::Ai>(prototype);
+    if (!ai || !ai::TaskStackHandle(ai->stackHandle).isValid())
+    {
+        return;
+    }
+    auto& ais = dstReg->storage<ecs::Ai>();
+    for (const entt::entity entity : entities)
+    {
+        auto stackHandle = taskSystem.copyTaskStackTo(
+            ai::TaskStackHandle(ai->stackHandle), sector->getTaskSystem());
+        ais.get(entity).stackHandle = stackHandle.toGenericHandle();
+    }
+}
 
-    // Spawn ship + modules
-    auto shipHull = ptr->engine->spawnShipHull(params.sector, hullHandle);
-    for (auto ms : modSlot)
+bool ShipRecipe::compile(ecs::PtrHandle* ptrHandle)
+{
+    if (prototype.compiled)
+    {
+        return prototype.valid;
+    }
+    prototype.compiled = true;
+    gobj::Hull* hull = ptrHandle->modManager->getHullLib().getItem(hullHandle);
+    if (!hull)
+    {
+        LG_E("Ship recipe: Could not find hull entry for {}",
+             hullHandle.toGenericHandle());
+        return false;
+    }
+    hullPrototype = prototype.reg.create();
+    ecs::SpawnCallbackParams hullParams{prototype.reg,
+                                        prototype.taskSystem,
+                                        hullPrototype,
+                                        ecs::EntityId::Invalid()};
+    if (!ShipHull::build(ptrHandle, hullParams, hullHandle))
     {
-        auto mod = ptr->engine->spawnModule(
-            params.sector, shipHull, ms.modHandle, ms.slot);
+        LG_E("Ship recipe: Failed to build hull prototype");
+        return false;
     }
+    for (const auto& ms : modSlot)
+    {
+        gobj::Module* module =
+            ptrHandle->modManager->getModuleLib().getItem(ms.modHandle);
+        if (!module || ms.slot >= hull->slots.size()
+            || hull->slots[ms.slot].type != module->slotType)
+        {
+            LG_W("Ship recipe: Skip incompatible module {} in slot {}",
+                 ms.modHandle.toGenericHandle(),
+                 ms.slot);
+            continue;
+        }
+        entt::entity entity = prototype.reg.create();
+        ecs::SpawnCallbackParams params{prototype.reg,
+                                        prototype.taskSystem,
+                                        entity,
+                                        ecs::EntityId::Invalid()};
+        if (!module::Module::buildParts(ptrHandle,
+                                        params,
+                                        ecs::EntityId::Invalid(),
+                                        ms.modHandle,
+                                        *module,
+                                        hull->slots[ms.slot]))
+        {
+            prototype.reg.destroy(entity);
+            continue;
+        }
+        modulePrototypes.push_back(
+            {(uint16_t)ms.slot, entity, module->type, module->slotType});
+    }
+    prototype.valid = true;
+    return true;
+}
 
-    // Update ship stats from modules
-    auto slot = ptr->registryMapping->getEntity(shipHull);
-    if (!slot)
+ecs::EntityId ShipRecipe::spawn(const RecipeSpawnParams& params)
+{
+    RecipeInstance instance{.pos = params.pos,
+                            .rot = params.rot,
+                            .vel = params.vel,
+                            .naturalRot = params.naturalRot};
+    std::vector<ecs::EntityId> spawned;
+    if (spawnBatch(params.ptrHandle, params.sector, {&instance, 1}, &spawned)
+        != 1)
     {
-        LG_E("No registry slot found for entity {}", shipHull);
         return ecs::EntityId::Invalid();
     }
-    auto reg = params.sector->getRegistry()->getRegistry();
-    ShipHull::updateStats(params.ptrHandle, reg, slot->entity);
+    return spawned.front();
+}
+
+uint32_t ShipRecipe::spawnBatch(ecs::PtrHandle* ptrHandle,
+                                world::Sector* sector,
+                                std::span<const RecipeInstance> instances,
+                                std::vector<ecs::EntityId>* spawned)
+{
+    if (!sector || instances.empty() || !compile(ptrHandle))
+    {
+        return 0;
+    }
+    const size_t count = instances.size();
+    auto* sectorReg = sector->getRegistry();
+    auto* reg = sectorReg->getRegistry();
+
+    // Spawn hulls, then one block of modules per slot
+    auto* arena = &con::alloc::FrameArena::local();
+    std::pmr::vector<entt::entity> hulls(count, arena);
+    std::pmr::vector<ecs::EntityId> hullIds(count, arena);
+    sectorReg->spawnObjects(hulls, hullIds);
+    prototype.stamp(ptrHandle, hullPrototype, sector, hulls);
+
+    std::pmr::vector<entt::entity> modules(count, arena);
+    std::pmr::vector<ecs::EntityId> moduleIds(count, arena);
+    auto& hullStorage = reg->storage<ecs::Hull>();
+    auto& anchors = reg->storage<ecs::AnchorFixed>();
+    auto& moduleStorage = reg->storage<ecs::Module>();
+    for (const auto& modProto : modulePrototypes)
+    {
+        sectorReg->spawnObjects(modules, moduleIds);
+        prototype.stamp(ptrHandle, modProto.entity, sector, modules);
+        for (size_t i = 0; i < count; i++)
+        {
+            anchors.get(modules[i]).ref = hullIds[i];
+            moduleStorage.get(modules[i]).parent = hullIds[i];
+            hullStorage.get(hulls[i]).addModule(
+                modProto.slot,
+                ecs::ModuleRef{moduleIds[i], modProto.type, modProto.slotType});
+        }
+    }
 
-    // Place at desired pos
-    Transform::position(reg, slot->entity, params.pos, params.rot);
-    params.sector->objectInitBroadphase(ptr, slot->entity);
-    ptr->engine->broadcastEntityToClients(shipHull);
-    return shipHull;
+    // Update ship stats from modules and place at desired pos
+    placeInstances(reg, hulls, instances);
+    for (const entt::entity hull : hulls)
+    {
+        ShipHull::updateStats(ptrHandle, reg, hull);
+    }
+    sector->objectsInitBroadphase(ptrHandle, hulls);
+    for (const auto& hullId : hullIds)
+    {
+        ptrHandle->engine->broadcastEntityToClients(hullId);
+    }
+    if (spawned)
+    {
+        spawned->insert(spawned->end(), hullIds.begin(), hullIds.end());
+    }
+    return count;
+}
+
+bool AsteroidRecipe::compile(ecs::PtrHandle* ptrHandle)
+{
+    if (prototype.compiled)
+    {
+        return prototype.valid;
+    }
+    prototype.compiled = true;
+    asteroidPrototype = prototype.reg.create();
+    ecs::SpawnCallbackParams params{prototype.reg,
+                                    prototype.taskSystem,
+                                    asteroidPrototype,
+                                    ecs::EntityId::Invalid()};
+    if (!Asteroid::build(ptrHandle, params, asteroidHandle, 0.0f))
+    {
+        LG_E("Asteroid recipe: Failed to build asteroid prototype");
+        return false;
+    }
+    prototype.valid = true;
+    return true;
 }
 
 ecs::EntityId AsteroidRecipe::spawn(const RecipeSpawnParams& params)
 {
-    auto ptr = params.ptrHandle;
+    RecipeInstance instance{.pos = params.pos,
+                            .rot = params.rot,
+                            .vel = params.vel,
+                            .naturalRot = params.naturalRot};
+    std::vector<ecs::EntityId> spawned;
+    if (spawnBatch(params.ptrHandle, params.sector, {&instance, 1}, &spawned)
+        != 1)
+    {
+        return ecs::EntityId::Invalid();
+    }
+    return spawned.front();
+}
 
-    // Spawn asteroid
-    auto asteroid = ptr->engine->spawnAsteroid(params.sector, asteroidHandle);
+uint32_t AsteroidRecipe::spawnBatch(ecs::PtrHandle* ptrHandle,
+                                    world::Sector* sector,
+                                    std::span<const RecipeInstance> instances,
+                                    std::vector<ecs::EntityId>* spawned)
+{
+    if (!sector || instances.empty() || !compile(ptrHandle))
+    {
+        return 0;
+    }
+    const size_t count = instances.size();
+    auto* sectorReg = sector->getRegistry();
+    auto* reg = sectorReg->getRegistry();
+
+    auto* arena = &con::alloc::FrameArena::local();
+    std::pmr::vector<entt::entity> asteroids(count, arena);
+    std::pmr::vector<ecs::EntityId> asteroidIds(count, arena);
+    sectorReg->spawnObjects(asteroids, asteroidIds);
+    prototype.stamp(ptrHandle, asteroidPrototype, sector, asteroids);
 
     // Place at desired pos and rotation
-    auto slot = ptr->registryMapping->getEntity(asteroid);
-    if (!slot)
+    placeInstances(reg, asteroids, instances);
+    sector->objectsInitBroadphase(ptrHandle, asteroids);
+    for (const auto& asteroidId : asteroidIds)
     {
-        LG_E("No registry slot found for entity {}", asteroid);
-        return ecs::EntityId::Invalid();
+        ptrHandle->engine->broadcastEntityToClients(asteroidId);
+    }
+    if (spawned)
+    {
+        spawned->insert(spawned->end(), asteroidIds.begin(), asteroidIds.end());
     }
-    auto reg = params.sector->getRegistry()->getRegistry();
-    Transform::position(reg, slot->entity, params.pos, params.rot);
-    Physics::naturalRot(reg, slot->entity, params.naturalRot);
-    params.sector->objectInitBroadphase(ptr, slot->entity);
-    ptr->engine->broadcastEntityToClients(asteroid);
-    return asteroid;
+    return count;
 }
 
 }  // namespace objb
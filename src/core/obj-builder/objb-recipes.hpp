@@ -10,6 +10,8 @@
 #include <mod-manager.hpp>
 #include <ptr-handle.hpp>
 #include <sector.hpp>
+#include <span>
+#include <task-system.hpp>
 
 namespace objb
 {
@@ -30,6 +32,31 @@ struct RecipeSpawnParams
     float naturalRot = 0.0f;
 };
 
+// Per instance part of a batch spawn
+struct RecipeInstance
+{
+    vec2 pos = vec2(0.0f, 0.0f);
+    float rot = 0.0f;
+    vec2 vel = vec2(0.0f, 0.0f);
+    float naturalRot = 0.0f;
+};
+
+// Component bundle of a recipe, built once with the regular objb builders
+// into a private registry. Instances are stamped out storage by storage with
+// entt range inserts instead of running the builders per entity.
+struct RecipePrototype
+{
+    entt::registry reg;
+    ai::TaskSystem taskSystem;
+    bool compiled = false;
+    bool valid = false;
+
+    void stamp(ecs::PtrHandle* ptrHandle,
+               entt::entity prototype,
+               world::Sector* sector,
+               std::span<const entt::entity> entities);
+};
+
 class ShipRecipe
 {
   public:
@@ -39,10 +66,28 @@ class ShipRecipe
     {
     }
     ecs::EntityId spawn(const RecipeSpawnParams& params);
+    // Spawns one ship per instance, returns the number of spawned ships.
+    // Hull ids are appended to spawned if given
+    uint32_t spawnBatch(ecs::PtrHandle* ptrHandle,
+                        world::Sector* sector,
+                        std::span<const RecipeInstance> instances,
+                        std::vector<ecs::EntityId>* spawned = nullptr);
+    bool compile(ecs::PtrHandle* ptrHandle);
 
   private:
+    struct ModulePrototype
+    {
+        uint16_t slot;
+        entt::entity entity;
+        gobj::ModuleType type;
+        gobj::ModuleSlotType slotType;
+    };
+
     gobj::HullHandle hullHandle;
     std::vector<ModuleSlot> modSlot;
+    RecipePrototype prototype;
+    entt::entity hullPrototype = entt::null;
+    std::vector<ModulePrototype> modulePrototypes;
 };
 
 class AsteroidRecipe
@@ -53,9 +98,16 @@ class AsteroidRecipe
     {
     }
     ecs::EntityId spawn(const RecipeSpawnParams& params);
+    uint32_t spawnBatch(ecs::PtrHandle* ptrHandle,
+                        world::Sector* sector,
+                        std::span<const RecipeInstance> instances,
+                        std::vector<ecs::EntityId>* spawned = nullptr);
+    bool compile(ecs::PtrHandle* ptrHandle);
 
   private:
     gobj::AsteroidHandle asteroidHandle;
+    RecipePrototype prototype;
+    entt::entity asteroidPrototype = entt::null;
 };
 
 }  // namespace objb
@@ -1,7 +1,7 @@
 #ifndef OBJ_POOL_HPP
 #define OBJ_POOL_HPP
 
-#include <free-vector.hpp>
+#include <dense-free-vector.hpp>
 
 namespace opool
 {
@@ -9,35 +9,44 @@ namespace opool
 template <class T> class ObjectPool
 {
   public:
+    using Handle = typename con::DenseFreeVec<T>::Handle;
+
     ObjectPool() {}
     ~ObjectPool() {}
-    con::FreeVec<T>::Handle
-    spawnObject(const T& object);
-    void destroyProjectile(con::FreeVec<T>::Handle);
-    void foreach (
-        std::function<
-            con::FreeVecForeachRet(T&, typename con::FreeVec<T>::Handle)> clb);
+    Handle spawnObject(const T& object);
+    void destroyProjectile(Handle handle);
+    T* getObject(Handle handle)
+    {
+        return pool.getItem(handle);
+    }
+    int size() const
+    {
+        return pool.size();
+    }
+    template <typename F> void forEach(F&& clb)
+    {
+        pool.forEach(std::forward<F>(clb));
+    }
+    void foreach (std::function<con::FreeVecForeachRet(T&, Handle)> clb);
 
   private:
-    con::FreeVec<T> pool;
+    con::DenseFreeVec<T> pool;
 };
 
 template <class T>
 void ObjectPool<T>::foreach (
-    std::function<con::FreeVecForeachRet(T&, typename con::FreeVec<T>::Handle)>
-        clb)
+    std::function<con::FreeVecForeachRet(T&, Handle)> clb)
 {
-    pool.foreach(clb);
+    pool.forEach(clb);
 }
 
-template <class T>
-void ObjectPool<T>::destroyProjectile(con::FreeVec<T>::Handle handle)
+template <class T> void ObjectPool<T>::destroyProjectile(Handle handle)
 {
     pool.removeItem(handle);
 }
 
 template <class T>
-con::FreeVec<T>::Handle ObjectPool<T>::spawnObject(const T& object)
+ObjectPool<T>::Handle ObjectPool<T>::spawnObject(const T& object)
 {
     auto handle = pool.addItem(object);
     return handle;
@@ -45,4 +54,4 @@ con::FreeVec<T>::Handle ObjectPool<T>::spawnObject(const T& object)
 
 };  // namespace opool
 
-#endif
\ No newline at end of file
+#endif
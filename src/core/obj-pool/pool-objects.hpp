@@ -14,6 +14,8 @@ struct Projectile
 {
     ecs::Transform transform;
     ecs::EntityId collExcept;
+    // Cache of collExcept in the sector the projectile lives in
+    ecs::LocalRef collExceptRef;
     gobj::ProjectileHandle proj;
     vec2 vel;
     float lifetimeMax;
@@ -0,0 +1,259 @@
+#ifndef PROJECTILE_STORE_HPP
+#define PROJECTILE_STORE_HPP
+
+#include "pool-objects.hpp"
+
+namespace opool
+{
+
+// Structure of arrays storage for projectiles. The hot per tick data
+// (position, velocity, lifetime) lives in separate float arrays so the
+// integration pass vectorizes; cold data (owner, lib handle) is only touched
+// by the broadphase pass on the survivors. Handles stay stable through a
+// sparse slot table like con::DenseFreeVec.
+class ProjectileStore
+{
+  public:
+    using Handle = ProjectileHandle;
+
+    ProjectileStore() {}
+    ~ProjectileStore() {}
+
+    Handle spawn(const Projectile& projectile)
+    {
+        uint32_t idx;
+        if (freeSlots.empty())
+        {
+            idx = sparse.size();
+            sparse.push_back({kNoDense, 1});
+        }
+        else
+        {
+            idx = freeSlots.back();
+            freeSlots.pop_back();
+            if (++sparse[idx].generation == 0)
+            {
+                sparse[idx].generation = 1;
+            }
+        }
+        sparse[idx].dense = posX.size();
+        denseToSparse.push_back(idx);
+        posX.push_back(projectile.transform.pos.x);
+        posY.push_back(projectile.transform.pos.y);
+        rot.push_back(projectile.transform.rot);
+        velX.push_back(projectile.vel.x);
+        velY.push_back(projectile.vel.y);
+        lifetime.push_back(projectile.lifetime);
+        lifetimeMax.push_back(projectile.lifetimeMax);
+        alive.push_back(1);
+        collExcept.push_back(projectile.collExcept);
+        collExceptRef.push_back(projectile.collExceptRef);
+        proj.push_back(projectile.proj);
+        return Handle(idx, sparse[idx].generation);
+    }
+
+    // Invalidates handle and flags its projectile, the lane is removed by
+    // the next compact() of the integrate pass
+    void destroy(Handle handle)
+    {
+        const uint32_t idx = handle.getIdx();
+        if (!handle.isValid() || idx >= sparse.size()
+            || sparse[idx].dense == kNoDense
+            || sparse[idx].generation != handle.getGeneration())
+        {
+            return;
+        }
+        alive[sparse[idx].dense] = 0;
+        if (++sparse[idx].generation == 0)
+        {
+            sparse[idx].generation = 1;
+        }
+    }
+
+    // Advances all projectiles by dt and flags the ones that expired or left
+    // the sector [-halfSize, halfSize]. Flagged projectiles are compacted
+    // away before returning.
+    void integrate(float dt, float halfSize)
+    {
+        const uint32_t n = posX.size();
+        float* __restrict px = posX.data();
+        float* __restrict py = posY.data();
+        const float* __restrict vx = velX.data();
+        const float* __restrict vy = velY.data();
+        float* __restrict lt = lifetime.data();
+        const float* __restrict ltMax = lifetimeMax.data();
+        uint8_t* __restrict al = alive.data();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            lt[i] += dt;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            al[i] = (lt[i] <= ltMax[i]) & (px[i] >= -halfSize)
+                    & (px[i] <= halfSize) & (py[i] >= -halfSize)
+                    & (py[i] <= halfSize);
+        }
+        compact();
+    }
+
+    // Flag a projectile by dense index, removed on the next compact()
+    void kill(uint32_t denseIdx)
+    {
+        alive[denseIdx] = 0;
+    }
+
+    // Stable in place compaction of all flagged projectiles
+    void compact()
+    {
+        const uint32_t n = posX.size();
+        uint32_t w = 0;
+        for (uint32_t r = 0; r < n; ++r)
+        {
+            const uint32_t idx = denseToSparse[r];
+            if (!alive[r])
+            {
+                sparse[idx].dense = kNoDense;
+                freeSlots.push_back(idx);
+                continue;
+            }
+            if (w != r)
+            {
+                posX[w] = posX[r];
+                posY[w] = posY[r];
+                rot[w] = rot[r];
+                velX[w] = velX[r];
+                velY[w] = velY[r];
+                lifetime[w] = lifetime[r];
+                lifetimeMax[w] = lifetimeMax[r];
+                alive[w] = 1;
+                collExcept[w] = collExcept[r];
+                collExceptRef[w] = collExceptRef[r];
+                proj[w] = proj[r];
+                denseToSparse[w] = idx;
+                sparse[idx].dense = w;
+            }
+            ++w;
+        }
+        if (w != n)
+        {
+            resize(w);
+        }
+    }
+
+    // Visits every projectile through an AoS copy, written back after the
+    // callback. Meant for cold paths like client dumps.
+    template <typename F> void forEach(F&& clb)
+    {
+        bool removed = false;
+        const uint32_t n = posX.size();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (!alive[i])
+            {
+                continue;
+            }
+            Projectile p = get(i);
+            auto ret = clb(p, getHandleAt(i));
+            set(i, p);
+            if (ret == con::FreeVecForeachRet::DESTROY)
+            {
+                alive[i] = 0;
+                removed = true;
+            }
+        }
+        if (removed)
+        {
+            compact();
+        }
+    }
+
+    uint32_t size() const
+    {
+        return posX.size();
+    }
+    vec2 getPos(uint32_t denseIdx) const
+    {
+        return vec2(posX[denseIdx], posY[denseIdx]);
+    }
+    const ecs::EntityId& getCollExcept(uint32_t denseIdx) const
+    {
+        return collExcept[denseIdx];
+    }
+    ecs::LocalRef& getCollExceptRef(uint32_t denseIdx)
+    {
+        return collExceptRef[denseIdx];
+    }
+    gobj::ProjectileHandle getProj(uint32_t denseIdx) const
+    {
+        return proj[denseIdx];
+    }
+    Handle getHandleAt(uint32_t denseIdx) const
+    {
+        const uint32_t idx = denseToSparse[denseIdx];
+        return Handle(idx, sparse[idx].generation);
+    }
+
+  private:
+    static constexpr uint32_t kNoDense = 0xffffffff;
+    struct SparseSlot
+    {
+        uint32_t dense;
+        uint16_t generation;
+    };
+
+    Projectile get(uint32_t i) const
+    {
+        return Projectile{.transform = {vec2(posX[i], posY[i]), rot[i]},
+                          .collExcept = collExcept[i],
+                          .collExceptRef = collExceptRef[i],
+                          .proj = proj[i],
+                          .vel = vec2(velX[i], velY[i]),
+                          .lifetimeMax = lifetimeMax[i],
+                          .lifetime = lifetime[i]};
+    }
+    void set(uint32_t i, const Projectile& p)
+    {
+        posX[i] = p.transform.pos.x;
+        posY[i] = p.transform.pos.y;
+        rot[i] = p.transform.rot;
+        velX[i] = p.vel.x;
+        velY[i] = p.vel.y;
+        lifetime[i] = p.lifetime;
+        lifetimeMax[i] = p.lifetimeMax;
+    }
+    void resize(uint32_t n)
+    {
+        posX.resize(n);
+        posY.resize(n);
+        rot.resize(n);
+        velX.resize(n);
+        velY.resize(n);
+        lifetime.resize(n);
+        lifetimeMax.resize(n);
+        alive.resize(n);
+        collExcept.resize(n);
+        collExceptRef.resize(n);
+        proj.resize(n);
+        denseToSparse.resize(n);
+    }
+
+    // Hot
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> lifetime;
+    std::vector<float> lifetimeMax;
+    std::vector<uint8_t> alive;
+    // Cold
+    std::vector<float> rot;
+    std::vector<ecs::EntityId> collExcept;
+    std::vector<ecs::LocalRef> collExceptRef;
+    std::vector<gobj::ProjectileHandle> proj;
+    std::vector<uint32_t> denseToSparse;
+    std::vector<SparseSlot> sparse;
+    std::vector<uint32_t> freeSlots;
+};
+
+}  // namespace opool
+
+#endif
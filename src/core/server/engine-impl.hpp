@@ -124,6 +124,7 @@ void Engine::registerActiveSectorDumpComponent(DumpFilter filter)
         name,
         [this, name, filter](const net::ClientInfo* clientInfo,
                              uint32_t sectorId,
+                             const DumpDelta& delta,
                              ecs::PtrHandle* ptrHandle)
         {
             prot::MsgComposer mcomp(net::SendType::UDP,
@@ -140,8 +141,11 @@ void Engine::registerActiveSectorDumpComponent(DumpFilter filter)
             size_t cntPos = mcomp.ser->adapter().currentWritePos();
             mcomp.ser->value2b((uint16_t)0);
 
+            auto& dumpStates = reg->storage<DumpState<Component>>();
+            const uint32_t frame = ptrHandle->frameCnt;
+
             // Go through entities in sector and append component if it
-            // exists
+            // changed since the last dump
             reg->view<ecs::EntityId, Component>().each(
                 [ptrHandle,
                  this,
@@ -152,6 +156,9 @@ void Engine::registerActiveSectorDumpComponent(DumpFilter filter)
                  &name,
                  &filter,
                  &reg,
+                 &dumpStates,
+                 &delta,
+                 frame,
                  sector](auto entity, auto& entityId, auto& component)
                 {
                     switch (filter)
@@ -169,6 +176,26 @@ void Engine::registerActiveSectorDumpComponent(DumpFilter filter)
                         default:
                             break;
                     }
+                    const uint64_t hash = serializedHash(component);
+                    if (!dumpStates.contains(entity))
+                    {
+                        dumpStates.emplace(
+                            entity, DumpState<Component>{hash, frame});
+                    }
+                    else
+                    {
+                        auto& dumpState = dumpStates.get(entity);
+                        if (dumpState.hash != hash)
+                        {
+                            dumpState.hash = hash;
+                            dumpState.changedFrame = frame;
+                        }
+                        else if (!delta.full
+                                 && dumpState.changedFrame <= delta.sinceFrame)
+                        {
+                            return;
+                        }
+                    }
                     mcomp.ser->object(entityId);
                     mcomp.ser->object(component);
                     entityCntMessage++;
@@ -1,7 +1,11 @@
+#ifdef SPHY_COUNT_HEAP_ALLOCS
+#include "alloc-counter.hpp"
+#endif
 #include "bitsery/serializer.h"
 #include "client-def.hpp"
 #include "comp-ai.hpp"
 #include "entt/entity/fwd.hpp"
+#include "frame-arena.hpp"
 #include "free-vector.hpp"
 #include "lib-projectile.hpp"
 #include "logging.hpp"
@@ -55,6 +59,7 @@ Engine::Engine(const sphy::CmdLinOptionsServer& options,
     ptrHandle->workDistributor = &workDistributor;
     ptrHandle->colliderLib = &modManager.getColliderLib();
     ptrHandle->modManager = &modManager;
+    ptrHandle->defCache = &defCache;
     ptrHandle->frameCnt = 0;
     ptrHandle->collisionLayerMat = &collisionLayerMat;
     ptrHandle->kpThrust =
@@ -67,20 +72,37 @@ Engine::Engine(const sphy::CmdLinOptionsServer& options,
         CFG_FLOAT(config, 0.1f, "engine", "physics", "lin-drag");
     ptrHandle->minFaceTargetDist =
         CFG_FLOAT(config, 1.0f, "engine", "physics", "min-face-target-dist");
+    ptrHandle->avoidHorizon =
+        CFG_FLOAT(config, 0.0f, "engine", "physics", "avoid-horizon");
+    ptrHandle->complexRot =
+        CFG_UINT(config, 1.0f, "engine", "physics", "complex-rot");
     slowDumpUs =
         1000 * CFG_UINT(config, 1000.0f, "engine", "upd", "dump-int", "slow");
     activeSectorDumpUs =
         1000
         * CFG_UINT(config, 30.0f, "engine", "upd", "dump-int", "active-sector");
+    activeSectorFullDumpUs =
+        1000
+        * CFG_UINT(
+            config, 1000.0f, "engine", "upd", "dump-int", "active-sector-full");
     ptrHandle->miningRate =
         CFG_FLOAT(config, 0.01f, "engine", "mining", "mining-rate");
     ptrHandle->itemLifetime =
         CFG_FLOAT(config, 600.0f, "engine", "items", "item-lifetime");
+    ptrHandle->rngSeed = CFG_UINT(config, 1.0f, "engine", "upd", "rng-seed");
+    ptrHandle->aiBudgetU =
+        CFG_UINT(config, 1000.0f, "engine", "ai", "budget-us");
+    ptrHandle->aiAgingFrames =
+        CFG_UINT(config, 30.0f, "engine", "ai", "aging-frames");
     int updThreads = CFG_UINT(config, 2.0f, "engine", "upd", "threads");
     maxFps = CFG_FLOAT(config, 600.0f, "engine", "upd", "max-fps");
 
     updThreads = std::clamp(updThreads, 1, 16);
     workDistributor.init(updThreads);
+    const bool mortonLayout =
+        CFG_UINT(config, 1.0f, "engine", "upd", "morton-layout");
+    world.setSectorLayout(mortonLayout ? con::MatrixLayout::Morton
+                                       : con::MatrixLayout::RowMajor);
 }
 
 Engine::~Engine()
@@ -100,14 +122,16 @@ void Engine::start()
 
     systems.registerSystem(ecs::sysLifetime, 0);
     systems.registerSystem(ecs::sysMoveCtrl, 1);
-    systems.registerSystem(ecs::sysPhyThrust, 2);
-    systems.registerSystem(ecs::sysPhysics, 3);
-    systems.registerSystem(ecs::sysProjPhysics, 4);
-    systems.registerSystem(ecs::sysItemPhysics, 5);
-    systems.registerSystem(ecs::sysCollisionDetection, 6);
-    systems.registerSystem(ecs::sysAnchorFixed, 7);
-    systems.registerSystem(ecs::sysAi, 8);
-    systems.registerSystem(ecs::sysTurret, 9);
+    systems.registerSystem(ecs::sysAvoidance, 2);
+    systems.registerSystem(ecs::sysPhyThrust, 3);
+    systems.registerSystem(ecs::sysPhysics, 4);
+    systems.registerSystem(ecs::sysProjPhysics, 5);
+    systems.registerSystem(ecs::sysItemPhysics, 6);
+    systems.registerSystem(ecs::sysCollisionDetection, 7);
+    systems.registerSystem(ecs::sysAnchorFixed, 8);
+    systems.registerSystem(ecs::sysAi, 9);
+    systems.registerSystem(ecs::sysTurretTarget, 10);
+    systems.registerSystem(ecs::sysTurret, 11);
 
     loadCollisionMatrix();
     registerConsoleCommands();
@@ -166,10 +190,28 @@ void Engine::engineLoop()
             nextFrame = now;
         filteredFps = 0.9f * filteredFps + 0.1f * (1.0f / dt);
 
-        DO_PERIODIC_U_EXTNOW(lastFpsUpdate,
-                             5000000,
-                             nowU,
-                             [this]() { LG_I("FPS: {}", filteredFps); });
+        DO_PERIODIC_U_EXTNOW(
+            lastFpsUpdate,
+            5000000,
+            nowU,
+            [this]()
+            {
+                LG_I("FPS: {}", filteredFps);
+                const auto arenaStats = con::alloc::FrameArena::collectStats();
+                LG_D(
+                    "Frame arena: capacity={} high water={} upstream allocs "
+                    "total={}",
+                    arenaStats.capacity,
+                    arenaStats.highWater,
+                    arenaStats.upstreamAllocTotal);
+#ifdef SPHY_COUNT_HEAP_ALLOCS
+                LG_D("Heap allocs in world update: total={} max per tick={}",
+                     tickHeapAllocsTotal,
+                     tickHeapAllocsMax);
+                tickHeapAllocsTotal = 0;
+                tickHeapAllocsMax = 0;
+#endif
+            });
 
         switch (state)
         {
@@ -234,6 +276,13 @@ void Engine::engineLoop()
         {
             parseCommandData(recQueueData);
         }
+
+        // One wakeup of the io thread per tick, it sends right away instead
+        // of polling the queue
+        if (sendNotifier && sendQueue.size_approx() > 0)
+        {
+            sendNotifier();
+        }
     }
 
     if (state == EngineState::Running || state == EngineState::Paused)
@@ -326,7 +375,17 @@ void Engine::update(float dt)
             }
         }
     }
+#ifdef SPHY_COUNT_HEAP_ALLOCS
+    // Counts every thread, the network threads included, so zero here means
+    // the world update did not touch the heap
+    const uint64_t allocsBefore = con::alloc::heapAllocCount();
+    world.update(dt, ptrHandle);
+    const uint64_t tickAllocs = con::alloc::heapAllocCount() - allocsBefore;
+    tickHeapAllocsMax = std::max(tickHeapAllocsMax, tickAllocs);
+    tickHeapAllocsTotal += tickAllocs;
+#else
     world.update(dt, ptrHandle);
+#endif
     markPlayerSectors();
 }
 
@@ -404,6 +463,13 @@ bool Engine::loadMods()
     {
         LG_E("Failed to load mods");
     }
+    // Hot systems only read definitions through the cache, rebuild it
+    // whenever the libraries changed
+    if (!defCache.validate())
+    {
+        defCache.build(modManager);
+        defCache.buildRecipes(ptrHandle);
+    }
     return true;
 }
 
@@ -1059,12 +1125,34 @@ void Engine::runActiveSectorDump(long frameTime)
             frameTime,
             [&]()
             {
-                for (auto& sectorId : clientInfo->getActiveSectors())
+                // Only changes since the last dump of a sector are sent,
+                // sectors that just became active and the periodic refresh
+                // send everything
+                const auto& activeSectors = clientInfo->getActiveSectors();
+                auto& dumpStates = clientInfo->sectorDumpStates;
+                std::erase_if(dumpStates,
+                              [&activeSectors](const auto& item)
+                              { return !activeSectors.contains(item.first); });
+                for (auto& sectorId : activeSectors)
                 {
+                    auto [it, inserted] = dumpStates.try_emplace(sectorId);
+                    auto& dumpState = it->second;
+                    const DumpDelta delta{
+                        .sinceFrame = dumpState.lastSentFrame,
+                        .full = inserted
+                                || frameTime - dumpState.lastFullDump
+                                       > activeSectorFullDumpUs};
                     for (auto& component : activeSectorUpdates)
                     {
-                        component.function(
-                            &clientInfo->clientInfo, sectorId, ptrHandle);
+                        component.function(&clientInfo->clientInfo,
+                                           sectorId,
+                                           delta,
+                                           ptrHandle);
+                    }
+                    dumpState.lastSentFrame = ptrHandle->frameCnt;
+                    if (delta.full)
+                    {
+                        dumpState.lastFullDump = frameTime;
                     }
                 }
                 sendProjectileInfo(clientInfo);
@@ -1084,7 +1172,7 @@ void Engine::sendProjectileInfo(def::ClientInfo* client)
     {
         mcomp.resetData();
         mcomp.startCommand(prot::cmd::SEND_PROJ_DATA, 0);
-        sector->foreachProj(
+        sector->forEachProj(
             [client, &mcomp, this](opool::Projectile& proj,
                                    opool::ProjectileHandle handle)
             {
@@ -1122,7 +1210,7 @@ void Engine::sendItemInfo(def::ClientInfo* client)
     {
         mcomp.resetData();
         mcomp.startCommand(prot::cmd::SEND_ITEM_DATA, 0);
-        sector->foreachItem(
+        sector->forEachItem(
             [client, &mcomp, this](opool::Item& item, opool::ItemHandle handle)
             {
                 mcomp.ser->object(handle.toGenericHandle());
@@ -1275,15 +1363,31 @@ void Engine::broadcastEntityToClients(ecs::EntityId entityId)
         });
 }
 
-void Engine::broadcastEntityDestructionToClients(ecs::EntityId entityId)
+void Engine::broadcastEntityDestructionToClients(
+    std::span<const ecs::EntityId> entityIds)
 {
+    if (entityIds.empty())
+    {
+        return;
+    }
+    // DESTROY_ENTITY carries a list of ids, only split at the chunk limit
     forActiveClients(
-        [this, entityId](def::ClientInfo* clientInfo)
+        [this, entityIds](def::ClientInfo* clientInfo)
         {
             prot::MsgComposer mcomp(net::SendType::TCP,
                                     clientInfo->clientInfo.connection);
             mcomp.startCommand(prot::cmd::DESTROY_ENTITY, 0);
-            mcomp.ser->object(entityId);
+            for (const auto& entityId : entityIds)
+            {
+                if (mcomp.ser->adapter().currentWritePos() + 6
+                    > prot::kMaxSerializedChunkBytes)
+                {
+                    mcomp.execute(sendQueue);
+                    mcomp.resetData();
+                    mcomp.startCommand(prot::cmd::DESTROY_ENTITY, 0);
+                }
+                mcomp.ser->object(entityId);
+            }
             mcomp.execute(sendQueue);
         });
 }
@@ -1314,10 +1418,21 @@ void Engine::sendAllComponents(world::Sector* sector,
     mcomp.ser->object(entityId);
     auto reg = sector->getRegistry()->getRegistry();
     uint16_t numComponents = 0;
-    for (auto& [hash, helper] :
-         assetFactory.componentFactory.getComponentHelpers())
+    // Walk the registry pools instead of all known component types, only
+    // components the entity has are visited
+    for (auto [storageId, storage] : reg->storage())
     {
-        helper.serializeFromRegistry(*reg, entity, *mcomp.ser);
+        if (!storage.contains(entity))
+        {
+            continue;
+        }
+        const auto* helper =
+            assetFactory.componentFactory.getHelperByStorage(storageId);
+        if (!helper)
+        {
+            continue;
+        }
+        helper->serializeFromRegistry(*reg, entity, *mcomp.ser);
         numComponents++;
         if (mcomp.ser->adapter().currentWritePos()
             >= prot::kMaxSerializedChunkBytes - 100)
@@ -1553,6 +1668,15 @@ part2->connectors.size());
         //                    0);
     }
     */
+    objb::AsteroidRecipe* rec = defCache.getAsteroidRecipe(
+        modManager.getAsteroidLib().getHandle("Small Asteroid 1"));
+    objb::AsteroidRecipe* rec2 = defCache.getAsteroidRecipe(
+        modManager.getAsteroidLib().getHandle("Small Asteroid 2"));
+    if (!rec || !rec2)
+    {
+        LG_W("Asteroid recipes for the test field are missing");
+        return;
+    }
     for (int i = 0; i < 10; ++i)
     {
         vec2 pos1 = vec2{posDist(gen), posDist(gen)};
@@ -1562,18 +1686,14 @@ part2->connectors.size());
         float rot1 = (rotDist(gen) - M_PIf) / 10.0f;
         float rot2 = (rotDist(gen) - M_PIf) / 10.0f;
 
-        objb::AsteroidRecipe rec(
-            modManager.getAsteroidLib().getHandle("Small Asteroid 1"));
-        rec.spawn({.ptrHandle = ptrHandle,
-                   .sector = sector,
-                   .pos = pos1,
-                   .naturalRot = rot1});
-        objb::AsteroidRecipe rec2(
-            modManager.getAsteroidLib().getHandle("Small Asteroid 2"));
-        rec2.spawn({.ptrHandle = ptrHandle,
+        rec->spawn({.ptrHandle = ptrHandle,
                     .sector = sector,
-                    .pos = pos2,
-                    .naturalRot = rot2});
+                    .pos = pos1,
+                    .naturalRot = rot1});
+        rec2->spawn({.ptrHandle = ptrHandle,
+                     .sector = sector,
+                     .pos = pos2,
+                     .naturalRot = rot2});
     }
 }
 
@@ -1735,17 +1855,19 @@ void Engine::handleThirdPersonControl(def::ClientInfo* clientInfo,
     auto* hull = reg->try_get<ecs::Hull>(slot->entity);
     if (hull)
     {
-        for (const auto& module : hull->modules)
+        auto* sectorReg = sector->getRegistry();
+        for (auto& module : hull->modules)
         {
             if (module.slotType == gobj::ModuleType::Turret)
             {
-                auto turrSlot = registryMapping.getEntity(module.entityId);
-                if (!turrSlot || turrSlot->sectorId != sector->getId())
+                const entt::entity turrEntity =
+                    sectorReg->resolve(module.entityId, module.localRef);
+                if (turrEntity == entt::null)
                 {
                     LG_W("Could not find turret for third person control");
                     continue;
                 }
-                auto* turret = reg->try_get<ecs::Turret>(turrSlot->entity);
+                auto* turret = reg->try_get<ecs::Turret>(turrEntity);
                 if (turret && turret->aimMode == ecs::Turret::AimMode::Player)
                 {
                     turret->fireMode = ecs::Turret::FireMode::Manual;
@@ -19,6 +19,7 @@
 #include <command-node.hpp>
 #include <config-manager/config-manager.hpp>
 #include <control-def.hpp>
+#include <def-cache.hpp>
 #include <functional>
 #include <item-lib.hpp>
 #include <lib-hull.hpp>
@@ -26,6 +27,7 @@
 #include <mod-manager.hpp>
 #include <net-shared.hpp>
 #include <ptr-handle.hpp>
+#include <span>
 #include <string>
 #include <task-system.hpp>
 #include <work-distributor.hpp>
@@ -42,8 +44,16 @@ namespace sphys
 typedef std::function<void(const net::ClientInfo* clientInfo,
                            ecs::PtrHandle* ptrHandle)>
     ClientDumpFunction;
+// Entities whose component changed after sinceFrame are dumped, all of them
+// if full is set
+struct DumpDelta
+{
+    uint32_t sinceFrame;
+    bool full;
+};
 typedef std::function<void(const net::ClientInfo* clientInfo,
                            uint32_t sectorId,
+                           const DumpDelta& delta,
                            ecs::PtrHandle* ptrHandle)>
     ActiveSectorUpdateFunction;
 struct CompClientDump
@@ -75,6 +85,32 @@ enum class DumpFilter
     Selectable,
 };
 
+// Change tracking of a dumped component, lives next to the component in the
+// sector registry. Changes are detected by hashing the serialized component,
+// which also catches in place modifications that bypass entt signals.
+template <typename Component> struct DumpState
+{
+    uint64_t hash;
+    uint32_t changedFrame;
+};
+
+template <typename Component>
+uint64_t serializedHash(const Component& component)
+{
+    thread_local Buffer buffer;
+    bitsery::Serializer<OutputAdapter> ser(OutputAdapter{buffer});
+    ser.object(component);
+    ser.adapter().flush();
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const size_t size = ser.adapter().writtenBytesCount();
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ buffer[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
 class Engine
 {
   public:
@@ -98,13 +134,21 @@ class Engine
     ecs::EntityId spawnAsteroid(world::Sector* sector,
                                 gobj::AsteroidHandle asteroidHandle);
 
+    // Called on the engine thread once per tick that left messages on
+    // sendQueue, must be set before start()
+    void setSendNotifier(std::function<void()> notifier)
+    {
+        sendNotifier = std::move(notifier);
+    }
+
     ConcurrentQueue<net::CmdQueueData> sendQueue;
     ConcurrentQueue<net::CmdQueueData> receiveQueue;
     template <class T> void registerSlowDumpComponent();
     template <class T>
     void registerActiveSectorDumpComponent(DumpFilter filter = DumpFilter::All);
     void broadcastEntityToClients(ecs::EntityId entityId);
-    void broadcastEntityDestructionToClients(ecs::EntityId entityId);
+    void broadcastEntityDestructionToClients(
+        std::span<const ecs::EntityId> entityIds);
 
   private:
     void engineLoop();
@@ -162,6 +206,7 @@ class Engine
     std::vector<def::ClientInfoHandle> connectedClientHandles;
     std::vector<def::ClientInfoHandle> activeClientHandles;
     mod::ModManager modManager;
+    mod::DefCache defCache;
     sthread::WorkDistributor workDistributor;
 
     EngineState state;
@@ -179,10 +224,17 @@ class Engine
 
     uint32_t slowDumpUs;
     uint32_t activeSectorDumpUs;
+    uint32_t activeSectorFullDumpUs;
     vector<CompClientDump> slowDumpComponents;
     vector<CompActiveSectorUpdate> activeSectorUpdates;
     float filteredFps = 0.0f;
+#ifdef SPHY_COUNT_HEAP_ALLOCS
+    // Heap allocations during the world update since the last FPS log
+    uint64_t tickHeapAllocsTotal = 0;
+    uint64_t tickHeapAllocsMax = 0;
+#endif
     float maxFps;
+    std::function<void()> sendNotifier;
 
     ecs::CollisionLayerMat collisionLayerMat;
 
@@ -8,7 +8,7 @@ namespace sphys
 Server::Server(sphy::CmdLinOptionsServer& options)
     : options(options),
       config(options.workingdir + "/modules/core/config/server.yaml"),
-      sendTimer(ioContext), signals(ioContext, SIGINT, SIGTERM),
+      signals(ioContext, SIGINT, SIGTERM),
       engine(options, config)
 {
     auto path(options.workingdir);
@@ -34,7 +34,6 @@ Server::~Server()
 
 void Server::shutdownNetworking()
 {
-    sendTimer.cancel();
     if (udpServer)
     {
         udpServer->close();
@@ -83,7 +82,7 @@ void Server::startUdpTcp()
                                                    std::placeholders::_3));
     LG_D("Setup socket on port-udp={}", portUdp);
 
-    boost::asio::post(ioContext, [this]() { scheduleSend(); });
+    engine.setSendNotifier([this]() { notifySend(); });
     ioThread = std::thread([this]() { ioContext.run(); });
 }
 
@@ -112,35 +111,46 @@ void Server::startEngine()
     engine.start();
 }
 
-void Server::scheduleSend()
+void Server::notifySend()
 {
-    sendTimer.expires_after(std::chrono::milliseconds(10));
-    sendTimer.async_wait(
-        [this](boost::system::error_code ec)
+    if (!sendPending.exchange(true))
+    {
+        boost::asio::post(ioContext, [this]() { drainSendQueue(); });
+    }
+}
+
+void Server::drainSendQueue()
+{
+    // Cleared first, a batch enqueued while draining posts a new drain
+    sendPending = false;
+    net::CmdQueueData sendRequest;
+    while (engine.sendQueue.try_dequeue(sendRequest))
+    {
+        const long sentU = tim::nowU();
+        if (sendRequest.sendType == net::SendType::UDP)
         {
-            if (!ec)
-            {
-                net::CmdQueueData sendRequest;
-                while (engine.sendQueue.try_dequeue(sendRequest))
-                {
-                    if (sendRequest.sendType == net::SendType::UDP)
-                    {
-                        udpServer->sendMessage(sendRequest.udpEndpoint,
-                                               sendRequest.data);
-                    }
-                    else if (sendRequest.sendType == net::SendType::TCP)
-                    {
-                        sendRequest.tcpConnection->sendMessage(
-                            sendRequest.data);
-                    }
-                }
-                scheduleSend();  // schedule next check
-            }
-            else
-            {
-                LG_E("Send timer aborted");
-            }
-        });
+            udpServer->sendMessage(sendRequest.udpEndpoint,
+                                   sendRequest.takeMsg());
+            udpSendLatency.add(sentU - sendRequest.enqueueU);
+        }
+        else if (sendRequest.sendType == net::SendType::TCP)
+        {
+            sendRequest.tcpConnection->sendMessage(sendRequest.payload());
+            tcpSendLatency.add(sentU - sendRequest.enqueueU);
+        }
+    }
+    const long nowU = tim::nowU();
+    DO_PERIODIC_U_EXTNOW(
+        lastSendLatencyLog,
+        TIM_10S,
+        nowU,
+        [this]()
+        {
+            LG_D("Send latency udp: {}", udpSendLatency.toString());
+            LG_D("Send latency tcp: {}", tcpSendLatency.toString());
+            udpSendLatency.reset();
+            tcpSendLatency.reset();
+        })
 }
 
 void Server::udpReceive(udp::endpoint endpoint, const char* data, size_t length)
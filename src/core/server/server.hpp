@@ -1,6 +1,7 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include <atomic>
 #include <boost/asio.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <tcp-server.hpp>
@@ -8,6 +9,7 @@
 #include <config-manager/config-manager.hpp>
 #include <engine.hpp>
 #include <cmd-options.hpp>
+#include <latency-histogram.hpp>
 
 namespace asio = boost::asio;
 using tcp = asio::ip::tcp;
@@ -27,7 +29,10 @@ class Server
 
   private:
     void shutdownNetworking();
-    void scheduleSend();
+    // Engine thread: wakes the io thread, at most one drain is pending
+    void notifySend();
+    // io thread: sends everything queued so far
+    void drainSendQueue();
     void udpReceive(udp::endpoint endpoint, const char* data, size_t length);
     //void tcpReceive(const char* data, size_t length, std::shared_ptr<net::TcpConnection> connection);
     void tcpReceive(const net::CmdQueueData& cmdData);
@@ -36,7 +41,11 @@ class Server
     cfg::ConfigManager config;
     boost::asio::io_context ioContext;
     std::thread ioThread;
-    asio::steady_timer sendTimer;
+    std::atomic<bool> sendPending{false};
+    // Enqueue -> handed to the socket, io thread only
+    net::LatencyHistogram udpSendLatency;
+    net::LatencyHistogram tcpSendLatency;
+    long lastSendLatencyLog = 0;
     std::unique_ptr<net::UdpServer> udpServer;
     std::unique_ptr<net::TcpServer> tcpServer;
     boost::asio::signal_set signals;
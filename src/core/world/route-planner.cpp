@@ -0,0 +1,425 @@
+#include "route-planner.hpp"
+#include <charconv>
+#include <config-manager.hpp>
+#include <frame-arena.hpp>
+#include <queue>
+#include <span>
+#ifdef SERVER
+#include <comp-phy.hpp>
+#include <comp-struct.hpp>
+#endif
+
+namespace world
+{
+
+namespace
+{
+
+constexpr float kSqrt2 = 1.41421356f;
+// Diagonal neighbours first so straight runs stay straight on ties
+constexpr int kNeighborDx[8] = {1, 1, -1, -1, 1, -1, 0, 0};
+constexpr int kNeighborDy[8] = {1, -1, 1, -1, 0, 0, 1, -1};
+
+}  // namespace
+
+void RoutePlanner::init(uint32_t numSectorX, uint32_t numSectorY)
+{
+    std::unique_lock lock(mutex);
+    this->numSectorX = numSectorX;
+    this->numSectorY = numSectorY;
+    costs.assign(numSectorX * numSectorY, 1.0f);
+    cache.clear();
+}
+
+void RoutePlanner::loadCosts(const cfg::ConfigManager& config)
+{
+    config.iterateThroughChildren(
+        {"world", "route-costs"},
+        [this](const cfg::ConfigNode& node)
+        {
+            const string& name = node.getName();
+            const char* end = name.data() + name.size();
+            def::SectorPos pos;
+            auto res = std::from_chars(name.data(), end, pos.x);
+            if (res.ec != std::errc() || res.ptr == end || *res.ptr != '-'
+                || std::from_chars(res.ptr + 1, end, pos.y).ec != std::errc())
+            {
+                LG_W("Invalid route cost entry {}, expected x-y", name);
+                return;
+            }
+            std::vector<string> path = {"blocked"};
+            const bool blocked =
+                std::get<float>(node.get(path, cfg::nodeVal_t(0.0f))) > 0.0f;
+            path = {"cost"};
+            const float cost =
+                std::get<float>(node.get(path, cfg::nodeVal_t(1.0f)));
+            setSectorCost(pos, blocked ? kBlocked : cost);
+        });
+}
+
+void RoutePlanner::setSectorCost(def::SectorPos pos, float cost)
+{
+    std::unique_lock lock(mutex);
+    if (pos.x >= numSectorX || pos.y >= numSectorY)
+    {
+        LG_W("Route cost for invalid sector {}", pos);
+        return;
+    }
+    costs[toIdx(pos)] = std::max(cost, 1.0f);
+    cache.clear();
+}
+
+float RoutePlanner::getSectorCost(def::SectorPos pos) const
+{
+    std::shared_lock lock(mutex);
+    if (pos.x >= numSectorX || pos.y >= numSectorY)
+    {
+        return kBlocked;
+    }
+    return costs[toIdx(pos)];
+}
+
+void RoutePlanner::clearCache()
+{
+    std::unique_lock lock(mutex);
+    cache.clear();
+}
+
+RouteRef RoutePlanner::findRoute(def::SectorPos from, def::SectorPos to)
+{
+    RouteRef route;
+    uint64_t key;
+    const uint32_t now = useClock.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::shared_lock lock(mutex);
+        if (from.x >= numSectorX || from.y >= numSectorY
+            || to.x >= numSectorX || to.y >= numSectorY)
+        {
+            return nullptr;
+        }
+        key = routeKey(toIdx(from), toIdx(to));
+        auto it = cache.find(key);
+        if (it != cache.end())
+        {
+            it->second.lastUse.store(now, std::memory_order_relaxed);
+            return it->second.route;
+        }
+        route = search(from, to);
+    }
+    // Unreachable goals are cached as well, a second worker that searched
+    // the same key meanwhile keeps the first result
+    std::unique_lock lock(mutex);
+    if (cache.size() >= kMaxCachedRoutes)
+    {
+        evictOldest();
+    }
+    return cache.try_emplace(key, std::move(route), now).first->second.route;
+}
+
+void RoutePlanner::evictOldest()
+{
+    // Ages relative to the clock, so the wrap around of the clock is harmless
+    const uint32_t now = useClock.load(std::memory_order_relaxed);
+    auto age = [now](const CacheEntry& entry)
+    { return now - entry.lastUse.load(std::memory_order_relaxed); };
+    std::pmr::vector<uint32_t> ages(&con::alloc::FrameArena::local());
+    ages.reserve(cache.size());
+    for (const auto& [key, entry] : cache)
+    {
+        ages.push_back(age(entry));
+    }
+    auto median = ages.begin() + ages.size() / 2;
+    std::nth_element(ages.begin(), median, ages.end(), std::greater<>());
+    const uint32_t maxAge = *median;
+    std::erase_if(cache,
+                  [&age, maxAge](const auto& item)
+                  { return age(item.second) >= maxAge; });
+}
+
+RouteRef RoutePlanner::search(def::SectorPos from, def::SectorPos to) const
+{
+    const uint32_t start = toIdx(from);
+    const uint32_t goal = toIdx(to);
+    if (costs[goal] == kBlocked)
+    {
+        return nullptr;
+    }
+    // Octile distance, admissible since no sector costs less than 1
+    auto heuristic = [&to, this](uint32_t idx)
+    {
+        const float dx = fabsf(float(idx % numSectorX) - float(to.x));
+        const float dy = fabsf(float(idx / numSectorX) - float(to.y));
+        return std::max(dx, dy) + (kSqrt2 - 1.0f) * std::min(dx, dy);
+    };
+
+    const uint32_t numSectors = costs.size();
+    auto* arena = &con::alloc::FrameArena::local();
+    std::pmr::vector<float> g(numSectors, kBlocked, arena);
+    std::pmr::vector<uint32_t> parent(numSectors, numSectors, arena);
+    std::pmr::vector<uint8_t> closed(numSectors, 0, arena);
+    using OpenEntry = std::pair<float, uint32_t>;
+    std::priority_queue<OpenEntry,
+                        std::pmr::vector<OpenEntry>,
+                        std::greater<>>
+        open(std::greater<>(), std::pmr::vector<OpenEntry>(arena));
+    g[start] = 0.0f;
+    open.push({heuristic(start), start});
+    while (!open.empty())
+    {
+        const uint32_t idx = open.top().second;
+        open.pop();
+        if (closed[idx])
+        {
+            continue;
+        }
+        closed[idx] = 1;
+        if (idx == goal)
+        {
+            break;
+        }
+        const int32_t x = idx % numSectorX;
+        const int32_t y = idx / numSectorX;
+        for (int k = 0; k < 8; k++)
+        {
+            const int32_t nx = x + kNeighborDx[k];
+            const int32_t ny = y + kNeighborDy[k];
+            if (nx < 0 || ny < 0 || nx >= (int32_t)numSectorX
+                || ny >= (int32_t)numSectorY)
+            {
+                continue;
+            }
+            const uint32_t nIdx = ny * numSectorX + nx;
+            if (closed[nIdx] || costs[nIdx] == kBlocked)
+            {
+                continue;
+            }
+            float step = costs[nIdx];
+            if (kNeighborDx[k] != 0 && kNeighborDy[k] != 0)
+            {
+                // No corner cutting, the border crossing would pass through
+                // the blocked sector
+                if (costs[y * numSectorX + nx] == kBlocked
+                    || costs[ny * numSectorX + x] == kBlocked)
+                {
+                    continue;
+                }
+                step *= kSqrt2;
+            }
+            const float ng = g[idx] + step;
+            if (ng < g[nIdx])
+            {
+                g[nIdx] = ng;
+                parent[nIdx] = idx;
+                open.push({ng + heuristic(nIdx), nIdx});
+            }
+        }
+    }
+    if (g[goal] == kBlocked)
+    {
+        return nullptr;
+    }
+
+    auto route = std::make_shared<Route>();
+    route->cost = g[goal];
+    for (uint32_t idx = goal; idx != numSectors; idx = parent[idx])
+    {
+        route->sectors.push_back({idx % numSectorX, idx / numSectorX});
+    }
+    std::reverse(route->sectors.begin(), route->sectors.end());
+    return route;
+}
+
+#ifdef SERVER
+namespace
+{
+
+// Waypoints per station ring and their distance relative to the obstacle
+// radius, must stay above 1 / cos(pi / kRingPoints) so ring edges clear it
+constexpr int kRingPoints = 8;
+constexpr float kRingScale = 1.3f;
+
+template <class Obstacle>
+bool segmentHits(const vec2& a, const vec2& b, const Obstacle& obstacle)
+{
+    const vec2 ab = b - a;
+    const float len2 = glm::dot(ab, ab);
+    float t = 0.0f;
+    if (len2 > 1e-8f)
+    {
+        t = std::clamp(glm::dot(obstacle.pos - a, ab) / len2, 0.0f, 1.0f);
+    }
+    const vec2 d = a + t * ab - obstacle.pos;
+    return glm::dot(d, d) < obstacle.radius * obstacle.radius;
+}
+
+template <class Obstacle>
+bool inside(const vec2& pos, const Obstacle& obstacle)
+{
+    return glm::length(pos - obstacle.pos) < obstacle.radius;
+}
+
+}  // namespace
+
+void SectorNavGraph::connect(entt::registry& registry)
+{
+    registry.on_construct<ecs::StationPart>()
+        .connect<&SectorNavGraph::onStationChanged>(*this);
+    registry.on_destroy<ecs::StationPart>()
+        .connect<&SectorNavGraph::onStationChanged>(*this);
+    dirty = true;
+}
+
+void SectorNavGraph::refresh(const entt::registry& registry)
+{
+    if (!dirty)
+    {
+        return;
+    }
+    dirty = false;
+    obstacles.clear();
+    nodes.clear();
+    // Broadphase boxes are good enough for stations
+    registry.view<ecs::StationPart, ecs::Broadphase>().each(
+        [this](auto entity, const auto& stationPart, const auto& broadphase)
+        {
+            const auto& box = broadphase.fatAABB;
+            obstacles.push_back({0.5f * (box.lower + box.upper),
+                                 0.5f * glm::length(box.upper - box.lower)});
+        });
+    for (const auto& obstacle : obstacles)
+    {
+        for (int i = 0; i < kRingPoints; i++)
+        {
+            const float angle = 2.0f * M_PIf * i / kRingPoints;
+            const vec2 node = obstacle.pos
+                              + kRingScale * obstacle.radius
+                                    * vec2(cosf(angle), sinf(angle));
+            if (std::none_of(obstacles.begin(),
+                             obstacles.end(),
+                             [&node](const Obstacle& other)
+                             { return inside(node, other); }))
+            {
+                nodes.push_back(node);
+            }
+        }
+    }
+    const size_t numNodes = nodes.size();
+    visible.assign(numNodes * numNodes, 0);
+    for (size_t i = 0; i < numNodes; i++)
+    {
+        for (size_t j = i + 1; j < numNodes; j++)
+        {
+            const bool free = std::none_of(
+                obstacles.begin(),
+                obstacles.end(),
+                [this, i, j](const Obstacle& obstacle)
+                { return segmentHits(nodes[i], nodes[j], obstacle); });
+            visible[i * numNodes + j] = free;
+            visible[j * numNodes + i] = free;
+        }
+    }
+}
+
+bool SectorNavGraph::plan(const vec2& from,
+                          const vec2& to,
+                          vector<vec2>& waypoints) const
+{
+    waypoints.clear();
+    // An obstacle around from or to (e.g. while docked) is ignored for the
+    // edges of from and to. The precomputed edges keep it, which at worst
+    // makes a plan fail and the ship fly straight.
+    auto segmentFree = [this, &from, &to](const vec2& a, const vec2& b)
+    {
+        for (const auto& obstacle : obstacles)
+        {
+            if (!inside(from, obstacle) && !inside(to, obstacle)
+                && segmentHits(a, b, obstacle))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (segmentFree(from, to))
+    {
+        return false;
+    }
+
+    // Node 0 is from, 1 is to, the graph nodes follow
+    const uint32_t numGraphNodes = nodes.size();
+    const uint32_t numNodes = numGraphNodes + 2;
+    auto* arena = &con::alloc::FrameArena::local();
+    auto nodePos = [this, &from, &to](uint32_t i) -> const vec2&
+    { return i == 0 ? from : (i == 1 ? to : nodes[i - 2]); };
+    // Edges of from and to, tested once per plan
+    std::pmr::vector<uint8_t> fromVisible(numNodes, 0, arena);
+    std::pmr::vector<uint8_t> toVisible(numNodes, 0, arena);
+    for (uint32_t i = 2; i < numNodes; i++)
+    {
+        fromVisible[i] = segmentFree(from, nodePos(i));
+        toVisible[i] = segmentFree(to, nodePos(i));
+    }
+    auto edgeFree = [&](uint32_t a, uint32_t b)
+    {
+        if (a == 0 || b == 0)
+        {
+            return a + b == 1 ? false : bool(fromVisible[a + b]);
+        }
+        if (a == 1 || b == 1)
+        {
+            return bool(toVisible[a + b - 1]);
+        }
+        return bool(visible[(a - 2) * numGraphNodes + (b - 2)]);
+    };
+
+    std::pmr::vector<float> g(numNodes, RoutePlanner::kBlocked, arena);
+    std::pmr::vector<uint32_t> parent(numNodes, numNodes, arena);
+    std::pmr::vector<uint8_t> closed(numNodes, 0, arena);
+    g[0] = 0.0f;
+    while (true)
+    {
+        // Few nodes per sector, a linear scan beats a heap here
+        uint32_t best = numNodes;
+        float bestF = RoutePlanner::kBlocked;
+        for (uint32_t i = 0; i < numNodes; i++)
+        {
+            const float f = g[i] + glm::length(to - nodePos(i));
+            if (!closed[i] && f < bestF)
+            {
+                bestF = f;
+                best = i;
+            }
+        }
+        if (best == numNodes || best == 1)
+        {
+            break;
+        }
+        closed[best] = 1;
+        for (uint32_t i = 0; i < numNodes; i++)
+        {
+            if (closed[i])
+            {
+                continue;
+            }
+            const float ng = g[best] + glm::length(nodePos(i) - nodePos(best));
+            if (ng < g[i] && edgeFree(best, i))
+            {
+                g[i] = ng;
+                parent[i] = best;
+            }
+        }
+    }
+    if (g[1] == RoutePlanner::kBlocked)
+    {
+        return false;
+    }
+    for (uint32_t i = 1; i != 0; i = parent[i])
+    {
+        waypoints.push_back(nodePos(i));
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
+#endif
+
+}  // namespace world
@@ -0,0 +1,120 @@
+#ifndef ROUTE_PLANNER_HPP
+#define ROUTE_PLANNER_HPP
+
+#include <atomic>
+#include <entt/entt.hpp>
+#include <memory>
+#include <shared_mutex>
+#include <std-inc.hpp>
+#include <unordered_map>
+#include <world-def.hpp>
+
+namespace cfg
+{
+class ConfigManager;
+}
+
+namespace world
+{
+
+// Sector level route, every sector from start to goal including both
+struct Route
+{
+    vector<def::SectorPos> sectors;
+    float cost;
+};
+using RouteRef = std::shared_ptr<const Route>;
+
+// A* over the sector grid (8 neighbours) with per sector traversal costs.
+// Routes are cached by (from, to) and shared by all callers, ships heading
+// for the same place search once. Safe to use from the sector workers.
+class RoutePlanner
+{
+  public:
+    static constexpr float kBlocked = std::numeric_limits<float>::infinity();
+
+    void init(uint32_t numSectorX, uint32_t numSectorY);
+    // Costs from the world.route-costs config, one child per sector named
+    // "x-y" with a cost and / or a blocked flag
+    void loadCosts(const cfg::ConfigManager& config);
+    // Cost of crossing a sector, at least 1. kBlocked takes the sector out of
+    // the graph. Drops all cached routes.
+    void setSectorCost(def::SectorPos pos, float cost);
+    float getSectorCost(def::SectorPos pos) const;
+    // nullptr if the goal can not be reached
+    RouteRef findRoute(def::SectorPos from, def::SectorPos to);
+    void clearCache();
+
+  private:
+    struct CacheEntry
+    {
+        explicit CacheEntry(RouteRef route, uint32_t lastUse)
+            : route(std::move(route)), lastUse(lastUse)
+        {
+        }
+        RouteRef route;
+        // Written under the shared lock, hence atomic
+        mutable std::atomic<uint32_t> lastUse;
+    };
+
+    RouteRef search(def::SectorPos from, def::SectorPos to) const;
+    // Drops the least recently used half of the cache, needs the unique lock
+    void evictOldest();
+    uint32_t toIdx(def::SectorPos pos) const
+    {
+        return pos.y * numSectorX + pos.x;
+    }
+    static uint64_t routeKey(uint32_t fromIdx, uint32_t toIdx)
+    {
+        return (uint64_t{fromIdx} << 32) | toIdx;
+    }
+
+    static constexpr size_t kMaxCachedRoutes = 4096;
+    uint32_t numSectorX = 0;
+    uint32_t numSectorY = 0;
+    // Row major, independent of the sector storage layout
+    vector<float> costs;
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t, CacheEntry> cache;
+    std::atomic<uint32_t> useClock{0};
+};
+
+#ifdef SERVER
+// Stations of one sector with a ring of waypoints around each and the
+// visibility between all waypoints. Stations do not move, so the graph is
+// only rebuilt when a station part is added or removed. A plan only adds the
+// edges of its start and goal.
+class SectorNavGraph
+{
+  public:
+    // Hooks the StationPart signals of registry to the dirty flag
+    void connect(entt::registry& registry);
+    // Must run before the AI of the sector decides, plan() only reads
+    void refresh(const entt::registry& registry);
+    // Waypoints from from to to that go around the stations, to itself is
+    // the last waypoint. False if the direct way is free.
+    bool plan(const vec2& from, const vec2& to, vector<vec2>& waypoints) const;
+
+  private:
+    struct Obstacle
+    {
+        vec2 pos;
+        float radius;
+    };
+
+    void onStationChanged(entt::registry& registry, entt::entity entity)
+    {
+        dirty = true;
+    }
+
+    bool dirty = true;
+    vector<Obstacle> obstacles;
+    vector<vec2> nodes;
+    // nodes.size() squared, 1 if the segment between two nodes is free
+    vector<uint8_t> visible;
+};
+#endif
+
+}  // namespace world
+
+#endif
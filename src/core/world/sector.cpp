@@ -10,6 +10,7 @@
 #ifdef SERVER
 #include "pool-objects.hpp"
 #include <engine.hpp>
+#include <frame-arena.hpp>
 #endif
 
 namespace world
@@ -39,6 +40,7 @@ void Sector::init(int x,
     dirty = true;
 #ifdef SERVER
     sectorRegistry.init(regMapping, this);
+    navGraph.connect(*sectorRegistry.getRegistry());
 #endif
 }
 
@@ -53,7 +55,7 @@ vec2 Sector::getWorldPosSectorOffset(int32_t sectorOffsetX,
 
 void Sector::spawnProjectile(const opool::Projectile& proj)
 {
-    projectilePool.spawnObject(proj);
+    projectileStore.spawn(proj);
 }
 
 void Sector::spawnItem(const opool::Item& item)
@@ -66,7 +68,7 @@ void Sector::foreachProj(
     std::function<con::FreeVecForeachRet(opool::Projectile&,
         opool::ProjectileHandle handle)> clb)
 {
-    projectilePool.foreach (clb);
+    projectileStore.forEach(clb);
 }
 
 void Sector::foreachItem(
@@ -149,9 +151,14 @@ bool Sector::saveSector(const std::string& savedir)
 
 void Sector::update(float dt, ecs::PtrHandle* ptrHandle)
 {
-    broadphaseQueryEntities.clear();
+    // All systems of a sector run on this worker, the query list can live on
+    // its arena
+    std::pmr::vector<entt::entity> queryEntities(
+        &con::alloc::FrameArena::local());
+    broadphaseQueryEntities = &queryEntities;
+    rng.reset(con::Rng::makeKey(ptrHandle->rngSeed, id, ptrHandle->frameCnt));
     ptrHandle->systems->runSystems(this, dt, ptrHandle);
-    destroyMarkedEntities(ptrHandle);
+    broadphaseQueryEntities = nullptr;
 }
 
 ecs::EntityId Sector::spawnObject(ecs::PtrHandle* ptrHandle,
@@ -191,9 +198,14 @@ bool Sector::migrateObject(ecs::PtrHandle* ptrHandle, ecs::EntityId entityId)
         LG_W("Entities last sector does not seem to exist");
         return false;
     }
-    bool res =
-        sectorRegistry.migrateEntity(entityId, slot, lastSector->getRegistry());
-    return res;
+    return migrateObjects(ptrHandle, lastSector, {&entityId, 1}) == 1;
+}
+
+uint32_t Sector::migrateObjects(ecs::PtrHandle* ptrHandle,
+                                Sector* lastSector,
+                                std::span<const ecs::EntityId> entityIds)
+{
+    return sectorRegistry.migrateEntities(ptrHandle, entityIds, lastSector);
 }
 
 void Sector::objectInitBroadphase(ecs::PtrHandle* ptrHandle,
@@ -225,6 +237,45 @@ void Sector::objectInitBroadphase(ecs::PtrHandle* ptrHandle,
     }
 }
 
+void Sector::objectsInitBroadphase(ecs::PtrHandle* ptrHandle,
+                                   std::span<const entt::entity> entities)
+{
+    auto reg = sectorRegistry.getRegistry();
+    auto& transforms = reg->storage<ecs::Transform>();
+    auto& colliders = reg->storage<ecs::Collider>();
+    auto& broadphases = reg->storage<ecs::Broadphase>();
+    auto& transformCaches = reg->storage<ecs::TransformCache>();
+    for (const entt::entity entity : entities)
+    {
+        if (!colliders.contains(entity) || !broadphases.contains(entity))
+        {
+            continue;
+        }
+        const auto& transform = transforms.get(entity);
+        auto& broadphase = broadphases.get(entity);
+        const float c = cosf(transform.rot);
+        const float s = sinf(transform.rot);
+        if (transformCaches.contains(entity))
+        {
+            auto& transformCache = transformCaches.get(entity);
+            transformCache.c = c;
+            transformCache.s = s;
+        }
+        con::AABB aabb = ecs::calculateAABB(
+            transform, {c, s}, colliders.get(entity), ptrHandle->colliderLib);
+        if (broadphase.proxyId <= ecs::Broadphase::INVALID_PROXY_ID)
+        {
+            broadphase.proxyId =
+                aabbTree.createProxy(aabb, BpUserData{BpUserType::Ecs, entity});
+        }
+        else
+        {
+            moveAabbProxy(broadphase.proxyId, aabb);
+        }
+        broadphase.fatAABB = aabb;
+    }
+}
+
 void Sector::destroyBroadphaseProxy(ecs::Broadphase* broadphase)
 {
     if (!broadphase)
@@ -250,29 +301,27 @@ void Sector::markEntityForDestruction(ecs::PtrHandle* ptrHandle,
     {
         return;
     }
-    if (flags.hasFlag(ecs::Flags::Flag::Moved))
-    {
-        sectorMoveRequests.erase(
-            std::remove_if(sectorMoveRequests.begin(),
-                           sectorMoveRequests.end(),
-                           [=](const SectorMoveRequest& request)
-                           { return request.entityId == entityId; }),
-            sectorMoveRequests.end());
-    }
+    // A pending move request stays queued, the Destroyed flag cancels it in
+    // forSectorMoveRequests
     flags.setFlag(ecs::Flags::Flag::Destroyed);
     entitiesToDestroy.push_back(entityId);
 }
 
-void Sector::destroyMarkedEntities(ecs::PtrHandle* ptrHandle)
+void Sector::destroyMarkedEntities(ecs::PtrHandle* ptrHandle,
+                                   vector<ecs::EntityId>& destroyed)
 {
-    for (const auto& entityId : entitiesToDestroy)
+    if (entitiesToDestroy.empty())
     {
-        if (!sectorRegistry.destroyObject(ptrHandle, entityId))
-        {
-            LG_W("Could not destroy entityId {}", entityId.toGenericHandle32());
-            continue;
-        }
-        ptrHandle->engine->broadcastEntityDestructionToClients(entityId);
+        return;
+    }
+    const uint32_t numDestroyed =
+        sectorRegistry.destroyObjects(ptrHandle, entitiesToDestroy, destroyed);
+    if (numDestroyed != entitiesToDestroy.size())
+    {
+        LG_W("Destroyed {} of {} entities in sector {}",
+             numDestroyed,
+             entitiesToDestroy.size(),
+             id);
     }
     entitiesToDestroy.clear();
 }
@@ -294,31 +343,38 @@ void Sector::executeSingleThreadedTasks(ecs::PtrHandle* ptrHandle)
 void Sector::addSectorMoveRequest(ecs::PtrHandle* ptrHandle,
                                   const SectorMoveRequest& request)
 {
-    /*
-    auto reg = ptrHandle->registry;
-    auto entity = ptrHandle->ecs->getEntity(request.entityId);
-    auto& flags = reg->get<ecs::Flags>(entity);
-
-    if (flags.hasFlag((ecs::Flags::Flag)(ecs::Flags::Flag::Destroyed
-                                         | ecs::Flags::Flag::Moved)))
+    auto reg = sectorRegistry.getRegistry();
+    auto slot = ptrHandle->registryMapping->getEntity(request.entityId);
+    if (!slot || slot->sectorId != id)
+    {
+        return;
+    }
+    auto& flags = reg->get<ecs::Flags>(slot->entity);
+    if (flags.hasFlag(ecs::Flags::Flag::MovedOrDestroyed))
     {
         return;
     }
     flags.setFlag(ecs::Flags::Flag::Moved);
     sectorMoveRequests.push_back(request);
-    */
 }
 
 void Sector::forSectorMoveRequests(
+    ecs::PtrHandle* ptrHandle,
     std::function<void(const SectorMoveRequest& request)> callback)
 {
-    /*
+    auto reg = sectorRegistry.getRegistry();
     for (const auto& request : sectorMoveRequests)
     {
+        auto slot = ptrHandle->registryMapping->getEntity(request.entityId);
+        if (!slot || slot->sectorId != id
+            || reg->get<ecs::Flags>(slot->entity)
+                   .hasFlag(ecs::Flags::Flag::Destroyed))
+        {
+            continue;
+        }
         callback(request);
     }
     sectorMoveRequests.clear();
-    */
 }
 
 #endif
@@ -15,6 +15,9 @@
 #include "registry-mapping.hpp"
 #include <obj-pool.hpp>
 #include <pool-objects.hpp>
+#include <projectile-store.hpp>
+#include <rng.hpp>
+#include <route-planner.hpp>
 #include <sector-registry.hpp>
 #include <task-system.hpp>
 #endif
@@ -72,19 +75,39 @@ class Sector
     ecs::EntityId spawnObject(ecs::PtrHandle* ptrHandle,
                               const ecs::SpawnCallback& spwnClb);
     bool migrateObject(ecs::PtrHandle* ptrHandle, ecs::EntityId entityId);
+    uint32_t migrateObjects(ecs::PtrHandle* ptrHandle,
+                            Sector* lastSector,
+                            std::span<const ecs::EntityId> entityIds);
     bool removeEntity(ecs::PtrHandle* ptrHandle, ecs::EntityId entityId);
     void markEntityForDestruction(ecs::PtrHandle* ptrHandle,
                                   ecs::EntityId entityId);
-    void destroyMarkedEntities(ecs::PtrHandle* ptrHandle);
+    // Destroys everything marked this tick, appends the destroyed ids. Must
+    // run at the post update barrier, it touches the shared id mapping.
+    void destroyMarkedEntities(ecs::PtrHandle* ptrHandle,
+                               vector<ecs::EntityId>& destroyed);
     void addSingleThreadedTask(SingleThreadedTaskFunction task);
     void executeSingleThreadedTasks(ecs::PtrHandle* ptrHandle);
     void addSectorMoveRequest(ecs::PtrHandle* ptrHandle,
                               const SectorMoveRequest& request);
+    // Skips requests of entities destroyed after requesting the move
     void forSectorMoveRequests(
+        ecs::PtrHandle* ptrHandle,
         std::function<void(const SectorMoveRequest& request)> callback);
     void moveAabbProxy(int32_t proxyId, con::AABB& newAabb);
     void destroyBroadphaseProxy(ecs::Broadphase* broadphase);
     void getAllAABBs(std::vector<con::AABB>& aabbs) const;
+    // Visitor overloads are inlined into the tree traversal, the
+    // std::function overloads are kept for cold paths
+    template <typename F>
+    void queryBroadphase(const con::AABB& aabb, F&& callback)
+    {
+        aabbTree.query(aabb, callback);
+    }
+    template <typename F>
+    void queryBroadphasePoint(const vec2& point, F&& callback)
+    {
+        aabbTree.queryPoint(point, callback);
+    }
     void queryBroadphase(const con::AABB& aabb,
                          std::function<void(const BpUserData&)> callback);
     void queryBroadphasePoint(const vec2& point,
@@ -92,6 +115,14 @@ class Sector
     void markPlayerSector(bool player);
     void update(float dt, ecs::PtrHandle* ptrHandle);
     bool saveSector(const std::string& savedir);
+    template <typename F> void forEachProj(F&& clb)
+    {
+        projectileStore.forEach(std::forward<F>(clb));
+    }
+    template <typename F> void forEachItem(F&& clb)
+    {
+        itemPool.forEach(std::forward<F>(clb));
+    }
     void foreachProj(
         std::function<con::FreeVecForeachRet(opool::Projectile&,
                                              opool::ProjectileHandle handle)>
@@ -130,6 +161,8 @@ class Sector
     }
 #ifdef SERVER
     void objectInitBroadphase(ecs::PtrHandle* ptrHandle, entt::entity entity);
+    void objectsInitBroadphase(ecs::PtrHandle* ptrHandle,
+                               std::span<const entt::entity> entities);
     ecs::SectorRegistry* getRegistry()
     {
         return &sectorRegistry;
@@ -138,11 +171,30 @@ class Sector
     {
         return taskSystem;
     }
+    // Reseeded from the world seed, sector id and frame every tick. Use it
+    // for all simulation randomness instead of rand().
+    con::Rng& getRng()
+    {
+        return rng;
+    }
+    opool::ProjectileStore& getProjectileStore()
+    {
+        return projectileStore;
+    }
+    // Station avoidance inside the sector, refreshed before the AI decides
+    SectorNavGraph& getNavGraph()
+    {
+        return navGraph;
+    }
     void spawnProjectile(const opool::Projectile& proj);
     void spawnItem(const opool::Item& item);
     inline void addBroadphaseQueryEntity(entt::entity entity)
     {
-        broadphaseQueryEntities.push_back(entity);
+        broadphaseQueryEntities->push_back(entity);
+    }
+    std::span<const entt::entity> getBroadphaseQueryEntities() const
+    {
+        return *broadphaseQueryEntities;
     }
 #endif
 #ifdef CLIENT
@@ -158,11 +210,12 @@ class Sector
                          float zoom);
 #endif
 
-    std::vector<std::pair<entt::entity, entt::entity>> broadphaseCollisions;
-    std::vector<entt::entity> broadphaseQueryEntities;
-    vector<ecs::ContactInfo> contactInfos;
-
   private:
+#ifdef SERVER
+    // Entities that moved this tick, lives on the frame arena for the
+    // duration of update()
+    std::pmr::vector<entt::entity>* broadphaseQueryEntities = nullptr;
+#endif
     int32_t coordX;        // Sector coord X
     int32_t coordY;        // Sector coord Y
     float sectorSize;      // Sector size
@@ -178,12 +231,14 @@ class Sector
     vector<SingleThreadedTaskFunction> singleThreadedTasks;
     vector<SectorMoveRequest> sectorMoveRequests;
     con::DynamicAABBTree<BpUserData> aabbTree;
-    opool::ObjectPool<opool::Projectile> projectilePool;
+    opool::ProjectileStore projectileStore;
     opool::ObjectPool<opool::Item> itemPool;
 #endif
     bool active = false;
 #ifdef SERVER
     ai::TaskSystem taskSystem;
+    con::Rng rng;
+    SectorNavGraph navGraph;
 #endif
 };
 
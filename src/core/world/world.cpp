@@ -2,8 +2,12 @@
 #include <comp-ai.hpp>
 #include <comp-ident.hpp>
 #include <config-manager.hpp>
+#include <frame-arena.hpp>
 #include <ptr-handle.hpp>
 #include <world.hpp>
+#ifdef SERVER
+#include <engine.hpp>
+#endif
 
 const uint16_t def::WorldShape::VERSION;
 
@@ -22,7 +26,10 @@ bool World::initWorld()
         LG_E("Invalid world shape. World initialization failed");
     }
     halfSectorSize = worldShape.sectorSize / 2.0f;
-    sectors.init(worldShape.numSectorX, worldShape.numSectorY);
+    sectors.init(worldShape.numSectorX, worldShape.numSectorY, sectorLayout);
+#ifdef SERVER
+    routePlanner.init(worldShape.numSectorX, worldShape.numSectorY);
+#endif
     LG_I("World initialized with {} sectors", sectors.getSize());
     return true;
 }
@@ -72,6 +79,7 @@ bool World::createFromConfig(cfg::ConfigManager& config,
         LG_E("World initialization failed");
         return false;
     }
+    routePlanner.loadCosts(config);
     if (!initSectors(false, ptrHandle))
     {
         LG_E("Sectors initialization failed");
@@ -101,6 +109,7 @@ bool World::createFromSave(cfg::ConfigManager& config,
         LG_E("World initialization failed");
         return false;
     }
+    routePlanner.loadCosts(config);
     if (!initSectors(true, ptrHandle))
     {
         LG_E("Sectors initialization failed");
@@ -173,18 +182,27 @@ void World::update(float dt, ecs::PtrHandle* ptrHandle)
             - Put physics/collission completely out of entt and into sector?
             -
     */
-    for (uint32_t sectorId = 0; sectorId < sectors.getSize(); sectorId++)
-    {
+    tickDt = dt;
+    tickPtrHandle = ptrHandle;
+    // Walk sectors in memory order and hand out contiguous runs, with the
+    // morton layout spatially adjacent sectors end up on the same worker
+    const uint32_t sectorCount = sectors.getSize();
+    const uint32_t threadCount = ptrHandle->workDistributor->getThreadCount();
+    for (uint32_t slot = 0; slot < sectorCount; slot++)
+    {
+        Sector* sector = sectors.at(sectors.slotToIdx(slot));
         ptrHandle->workDistributor->addWork(
-            [this, sectorId, dt, ph = ptrHandle]()
-            { sectors.at(sectorId)->update(dt, ph); },
-            sectorId % ptrHandle->workDistributor->getThreadCount());
+            [this, sector]() { sector->update(tickDt, tickPtrHandle); },
+            (uint64_t)slot * threadCount / sectorCount);
     }
     ptrHandle->workDistributor->awaken();
     ptrHandle->workDistributor->waitForEmptyQueues();
     ptrHandle->workDistributor->suspend();
     executeSingleThreadedTasks(ptrHandle);
+    destroyMarkedEntities(ptrHandle);
     handleSectorMoveRequests(ptrHandle);
+    // Workers are idle, drop all per tick scratch memory
+    con::alloc::FrameArena::resetAll();
 }
 #endif
 
@@ -319,80 +337,25 @@ bool World::switchSector(ecs::PtrHandle* ptrHandle,
                          ecs::EntityId entityId,
                          uint32_t newSectorId)
 {
-    /*
-    if (!ptrHandle->ecs->validId(entityId))
+    const ecs::EntMapSlot* slot =
+        ptrHandle->registryMapping->getEntity(entityId);
+    if (!slot)
     {
         LG_W("Entity not valid: {}", entityId);
         return false;
     }
-    Sector* newSector = sectors.at(newSectorId);
-    if (newSector == nullptr)
-    {
-        LG_W("Sector not found: {}", newSectorId);
-        return false;
-    }
-
-    auto reg = ptrHandle->registry;
-    entt::entity entity = ptrHandle->ecs->getEntity(entityId);
-    if (entity == entt::null)
-    {
-        LG_W("Entity not valid for switchSector: {}", entityId);
-        return false;
-    }
-    auto* ai = reg->try_get<ecs::Ai>(entity);
-    auto* sector = reg->try_get<ecs::SectorId>(entity);
-    if (sector && sector->id == newSectorId)
+    if (slot->sectorId == newSectorId)
     {
         return true;
     }
-    if (sector && sector->id != INVALID_SECTOR_ID && sector->id != newSectorId)
-    {
-        Sector* oldSector = sectors.at(sector->id);
-        if (oldSector)
-        {
-            if (ai)
-            {
-                ai::TaskStackHandle stackHandle(ai->stackHandle);
-                if (stackHandle.isValid())
-                {
-                    ai::TaskSystem* sourceSystem = &oldSector->getTaskSystem();
-                    if (!sourceSystem->getTaskStack(stackHandle)
-                        && ptrHandle->taskSystem)
-                    {
-                        sourceSystem = ptrHandle->taskSystem;
-                    }
-                    auto newStackHandle = sourceSystem->moveTaskStackTo(
-                        stackHandle, newSector->getTaskSystem());
-                    if (newStackHandle.isValid())
-                    {
-                        ai->stackHandle = newStackHandle.toGenericHandle();
-                    }
-                    else
-                    {
-                        LG_W(
-                            "Failed to move task stack for entity {}, "
-                            "creating new stack",
-                            entityId);
-                        auto newStackHandle =
-                            newSector->getTaskSystem().createTaskStack(
-                                ai::taskdata::Idle());
-                        ai->stackHandle = newStackHandle.toGenericHandle();
-                    }
-                }
-            }
-            oldSector->removeEntity(ptrHandle, entityId);
-        }
-    }
-    if (!newSector->addEntity(ptrHandle, entityId))
+    Sector* oldSector = sectors.at(slot->sectorId);
+    Sector* newSector = sectors.at(newSectorId);
+    if (!oldSector || !newSector)
     {
-        LG_E("switchSector: failed to add entity {} to sector {}",
-             entityId,
-             newSectorId);
+        LG_W("Sector not found: {} -> {}", slot->sectorId, newSectorId);
         return false;
     }
-    return true;
-    */
-    return false;
+    return newSector->migrateObjects(ptrHandle, oldSector, {&entityId, 1}) == 1;
 }
 
 void World::checkSectorSwitchAfterMove(ecs::EntityId entityId,
@@ -588,21 +551,72 @@ void World::checkSectorSwitchAfterMove(ecs::EntityId entityId,
     }
 }
 
+void World::destroyMarkedEntities(ecs::PtrHandle* ptrHandle)
+{
+    destroyedEntities.clear();
+    for (uint32_t sectorId = 0; sectorId < sectors.getSize(); sectorId++)
+    {
+        sectors.at(sectorId)->destroyMarkedEntities(ptrHandle,
+                                                    destroyedEntities);
+    }
+    // One message per client for the whole tick
+    ptrHandle->engine->broadcastEntityDestructionToClients(destroyedEntities);
+}
+
 void World::handleSectorMoveRequests(ecs::PtrHandle* ptrHandle)
 {
+    // Requests are grouped by (source, target) so a fleet crossing a border
+    // together is moved in one batch
+    std::pmr::vector<ecs::EntityId> batch(&con::alloc::FrameArena::local());
     for (uint32_t sectorId = 0; sectorId < sectors.getSize(); sectorId++)
     {
-        sectors.at(sectorId)->forSectorMoveRequests(
-            [this, ptrHandle](const SectorMoveRequest& request)
+        Sector* sector = sectors.at(sectorId);
+        moveRequestBatch.clear();
+        sector->forSectorMoveRequests(
+            ptrHandle,
+            [this](const SectorMoveRequest& request)
+            { moveRequestBatch.push_back(request); });
+        if (moveRequestBatch.empty())
+        {
+            continue;
+        }
+        std::stable_sort(moveRequestBatch.begin(),
+                         moveRequestBatch.end(),
+                         [](const SectorMoveRequest& a,
+                            const SectorMoveRequest& b)
+                         { return a.newSectorId < b.newSectorId; });
+        size_t first = 0;
+        while (first < moveRequestBatch.size())
+        {
+            const uint32_t newSectorId = moveRequestBatch[first].newSectorId;
+            batch.clear();
+            size_t last = first;
+            for (; last < moveRequestBatch.size()
+                   && moveRequestBatch[last].newSectorId == newSectorId;
+                 last++)
             {
-                if (!switchSector(
-                        ptrHandle, request.entityId, request.newSectorId))
-                {
-                    LG_E("Failed to switch sector for entity: {} to sector: {}",
-                         request.entityId,
-                         request.newSectorId);
-                }
-            });
+                batch.push_back(moveRequestBatch[last].entityId);
+            }
+            first = last;
+            Sector* newSector = sectors.at(newSectorId);
+            if (!newSector)
+            {
+                LG_E("Failed to switch {} entities to sector: {}",
+                     batch.size(),
+                     newSectorId);
+                continue;
+            }
+            const uint32_t moved =
+                newSector->migrateObjects(ptrHandle, sector, batch);
+            if (moved != batch.size())
+            {
+                LG_E("Switched {} of {} entities from sector {} to sector {}",
+                     moved,
+                     batch.size(),
+                     sectorId,
+                     newSectorId);
+            }
+        }
     }
 }
 
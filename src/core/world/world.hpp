@@ -4,6 +4,7 @@
 #include <comp-ident.hpp>
 #include <config-manager.hpp>
 #include <matrix2d.hpp>
+#include <route-planner.hpp>
 #include <sector.hpp>
 #include <std-inc.hpp>
 #include <work-distributor.hpp>
@@ -49,6 +50,11 @@ class World
     bool createFromServer(const def::WorldShape& worldShape,
                           ecs::PtrHandle* ptrHandle);
 #endif
+    // Storage order of the sectors, must be set before the world is created
+    void setSectorLayout(con::MatrixLayout layout)
+    {
+        sectorLayout = layout;
+    }
     void iterateSectors(IterateSectorClb clb);
     Sector* getSector(uint32_t sectorId);
     uint32_t getSectorCount() const
@@ -84,6 +90,11 @@ class World
     void addSectorMoveRequest(ecs::PtrHandle* ptrHandle,
                               ecs::EntityId entityId,
                               uint32_t newSectorId);
+    // Shared sector route planner of the AI
+    RoutePlanner& getRoutePlanner()
+    {
+        return routePlanner;
+    }
     bool moveEntityTo(ecs::PtrHandle* ptrHandle,
                       ecs::EntityId entityId,
                       uint32_t sectorId,
@@ -104,11 +115,25 @@ class World
                               bitsery::Deserializer<InputAdapter>& des_);
     void handleSectorMoveRequests(ecs::PtrHandle* ptrHandle);
     void executeSingleThreadedTasks(ecs::PtrHandle* ptrHandle);
+    void destroyMarkedEntities(ecs::PtrHandle* ptrHandle);
 #endif
     def::WorldShape worldShape;
     con::Matrix2D<Sector> sectors;
+    con::MatrixLayout sectorLayout = con::MatrixLayout::RowMajor;
     bool dirty;
     float halfSectorSize;
+#ifdef SERVER
+    // Per tick arguments of the sector work items, read by the workers
+    // instead of being captured, keeps the work lambda within the small
+    // buffer of std::function
+    float tickDt = 0.0f;
+    ecs::PtrHandle* tickPtrHandle = nullptr;
+    // Move requests of the sector being handled, reused across ticks
+    vector<SectorMoveRequest> moveRequestBatch;
+    // Entities destroyed this tick over all sectors, reused across ticks
+    vector<ecs::EntityId> destroyedEntities;
+    RoutePlanner routePlanner;
+#endif
 };
 
 }  // namespace world
@@ -2,7 +2,9 @@
 #define AABB_TREE_HPP
 
 #include <cassert>
+#include <array>
 #include <cstdint>
+#include <frame-arena.hpp>
 #include <glm/glm.hpp>
 #include <limits>
 #include <stack>
@@ -152,13 +154,19 @@ template <typename T> class DynamicAABBTree
         if (root == -1)
             return;
 
-        std::stack<int> stack;
-        stack.push(root);
+        // Traversal stack lives on the call stack, only trees deeper than
+        // kQueryStackInline spill into the frame arena
+        std::array<int, kQueryStackInline> stackBuf;
+        std::pmr::monotonic_buffer_resource stackRes(
+            stackBuf.data(), sizeof(stackBuf), &alloc::FrameArena::local());
+        std::pmr::vector<int> stack(&stackRes);
+        stack.reserve(kQueryStackInline);
+        stack.push_back(root);
 
         while (!stack.empty())
         {
-            int node = stack.top();
-            stack.pop();
+            int node = stack.back();
+            stack.pop_back();
 
             if (!nodes[node].box.overlaps(box))
                 continue;
@@ -169,8 +177,8 @@ template <typename T> class DynamicAABBTree
             }
             else
             {
-                stack.push(nodes[node].left);
-                stack.push(nodes[node].right);
+                stack.push_back(nodes[node].left);
+                stack.push_back(nodes[node].right);
             }
         }
     }
@@ -181,13 +189,17 @@ template <typename T> class DynamicAABBTree
         if (root == -1)
             return;
 
-        std::stack<int> stack;
-        stack.push(root);
+        std::array<int, kQueryStackInline> stackBuf;
+        std::pmr::monotonic_buffer_resource stackRes(
+            stackBuf.data(), sizeof(stackBuf), &alloc::FrameArena::local());
+        std::pmr::vector<int> stack(&stackRes);
+        stack.reserve(kQueryStackInline);
+        stack.push_back(root);
 
         while (!stack.empty())
         {
-            int node = stack.top();
-            stack.pop();
+            int node = stack.back();
+            stack.pop_back();
 
             if (!nodes[node].box.containsPoint(point))
                 continue;
@@ -198,8 +210,8 @@ template <typename T> class DynamicAABBTree
             }
             else
             {
-                stack.push(nodes[node].left);
-                stack.push(nodes[node].right);
+                stack.push_back(nodes[node].left);
+                stack.push_back(nodes[node].right);
             }
         }
     }
@@ -228,6 +240,8 @@ template <typename T> class DynamicAABBTree
     }
 
   private:
+    static constexpr size_t kQueryStackInline = 64;
+
     std::vector<Node> nodes;
     int root = -1;
     int freeList = -1;
@@ -0,0 +1,235 @@
+#ifndef DENSE_FREE_VECTOR_HPP
+#define DENSE_FREE_VECTOR_HPP
+
+#include <cassert>
+#include <free-vector.hpp>
+
+namespace con
+{
+
+// Packed counterpart to FreeVec. Live items are kept contiguous in `items`,
+// handles go through a sparse slot table (idx -> dense position) so they stay
+// stable while items are swap-removed. Handles are interchangeable with
+// FreeVec<T>::Handle.
+template <class T> class DenseFreeVec
+{
+  public:
+    using Handle = typename FreeVec<T>::Handle;
+
+    DenseFreeVec() {}
+    ~DenseFreeVec() {}
+
+    Handle addItem(const T& item);
+    Handle addItem(T&& item);
+    void removeItem(Handle handle);
+    void clear();
+    void reserve(size_t count);
+
+    // Visits every live item in dense order. The callback returns
+    // FreeVecForeachRet::DESTROY to swap-remove the current item, the swapped
+    // in item is visited next. The callback must not call removeItem, a
+    // swap-remove of another item would skip or revisit the moved one.
+    template <typename F> void forEach(F&& clb);
+    void foreach (std::function<FreeVecForeachRet(T&, Handle)> clb)
+    {
+        forEach(clb);
+    }
+
+    T* getItem(Handle handle);
+    const T* getItem(Handle handle) const;
+    bool contains(Handle handle) const;
+    Handle getHandleAt(uint32_t denseIdx) const
+    {
+        const uint32_t idx = denseToSparse[denseIdx];
+        return Handle(idx, sparse[idx].generation);
+    }
+
+    T* data()
+    {
+        return items.data();
+    }
+    int size() const
+    {
+        return items.size();
+    }
+    bool isEmpty() const
+    {
+        return items.empty();
+    }
+    int getFreeSlotCount() const
+    {
+        return freeSlots.size();
+    }
+    int getSlotCount() const
+    {
+        return sparse.size();
+    }
+
+  private:
+    static constexpr uint32_t kNoDense = 0xffffffff;
+    struct SparseSlot
+    {
+        uint32_t dense;
+        uint16_t generation;
+    };
+
+    uint32_t allocSlot();
+    void removeDense(uint32_t denseIdx);
+    const SparseSlot* getSlot(Handle handle) const;
+
+    std::vector<T> items;
+    std::vector<uint32_t> denseToSparse;
+    std::vector<SparseSlot> sparse;
+    std::vector<uint32_t> freeSlots;
+#ifdef DEBUG
+    bool iterating = false;
+#endif
+};
+
+template <class T> uint32_t DenseFreeVec<T>::allocSlot()
+{
+    uint32_t idx;
+    if (freeSlots.empty())
+    {
+        idx = sparse.size();
+        sparse.push_back({kNoDense, 1});
+    }
+    else
+    {
+        idx = freeSlots.back();
+        freeSlots.pop_back();
+        // Generation 0 marks invalid handles, skip it on wrap around
+        if (++sparse[idx].generation == 0)
+        {
+            sparse[idx].generation = 1;
+        }
+    }
+    sparse[idx].dense = items.size();
+    denseToSparse.push_back(idx);
+    return idx;
+}
+
+template <class T>
+DenseFreeVec<T>::Handle DenseFreeVec<T>::addItem(const T& item)
+{
+    const uint32_t idx = allocSlot();
+    items.push_back(item);
+    return Handle(idx, sparse[idx].generation);
+}
+
+template <class T> DenseFreeVec<T>::Handle DenseFreeVec<T>::addItem(T&& item)
+{
+    const uint32_t idx = allocSlot();
+    items.push_back(std::move(item));
+    return Handle(idx, sparse[idx].generation);
+}
+
+template <class T> void DenseFreeVec<T>::removeDense(uint32_t denseIdx)
+{
+    const uint32_t last = items.size() - 1;
+    const uint32_t idx = denseToSparse[denseIdx];
+    if (denseIdx != last)
+    {
+        items[denseIdx] = std::move(items[last]);
+        denseToSparse[denseIdx] = denseToSparse[last];
+        sparse[denseToSparse[denseIdx]].dense = denseIdx;
+    }
+    items.pop_back();
+    denseToSparse.pop_back();
+    sparse[idx].dense = kNoDense;
+    freeSlots.push_back(idx);
+}
+
+template <class T> void DenseFreeVec<T>::removeItem(Handle handle)
+{
+#ifdef DEBUG
+    assert(!iterating && "remove inside forEach through its return value");
+#endif
+    if (const SparseSlot* slot = getSlot(handle))
+    {
+        removeDense(slot->dense);
+    }
+}
+
+template <class T> void DenseFreeVec<T>::clear()
+{
+    for (uint32_t denseIdx = 0; denseIdx < denseToSparse.size(); ++denseIdx)
+    {
+        const uint32_t idx = denseToSparse[denseIdx];
+        sparse[idx].dense = kNoDense;
+        freeSlots.push_back(idx);
+    }
+    items.clear();
+    denseToSparse.clear();
+}
+
+template <class T> void DenseFreeVec<T>::reserve(size_t count)
+{
+    items.reserve(count);
+    denseToSparse.reserve(count);
+    sparse.reserve(count);
+}
+
+template <class T>
+template <typename F>
+void DenseFreeVec<T>::forEach(F&& clb)
+{
+#ifdef DEBUG
+    iterating = true;
+#endif
+    uint32_t i = 0;
+    while (i < items.size())
+    {
+        const uint32_t idx = denseToSparse[i];
+        auto ret = clb(items[i], Handle(idx, sparse[idx].generation));
+        if (ret == FreeVecForeachRet::DESTROY)
+        {
+            removeDense(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+#ifdef DEBUG
+    iterating = false;
+#endif
+}
+
+template <class T>
+const typename DenseFreeVec<T>::SparseSlot*
+DenseFreeVec<T>::getSlot(Handle handle) const
+{
+    const uint32_t idx = handle.getIdx();
+    if (!handle.isValid() || idx >= sparse.size())
+    {
+        return nullptr;
+    }
+    const SparseSlot& slot = sparse[idx];
+    if (slot.dense == kNoDense || slot.generation != handle.getGeneration())
+    {
+        return nullptr;
+    }
+    return &slot;
+}
+
+template <class T> T* DenseFreeVec<T>::getItem(Handle handle)
+{
+    const SparseSlot* slot = getSlot(handle);
+    return slot ? &items[slot->dense] : nullptr;
+}
+
+template <class T> const T* DenseFreeVec<T>::getItem(Handle handle) const
+{
+    const SparseSlot* slot = getSlot(handle);
+    return slot ? &items[slot->dense] : nullptr;
+}
+
+template <class T> bool DenseFreeVec<T>::contains(Handle handle) const
+{
+    return getSlot(handle) != nullptr;
+}
+
+}  // namespace con
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace con::alloc
+{
+
+// Bump allocator for per tick scratch memory. Each worker thread owns one
+// arena (FrameArena::local()), so allocating never takes a lock. Memory is
+// only released in bulk with reset(). If a tick overflowed the main block,
+// reset() replaces it with one block large enough for the whole tick, so a
+// steady state tick does no upstream allocation at all.
+class FrameArena : public std::pmr::memory_resource
+{
+  public:
+    static constexpr size_t kDefaultCapacity = 256 * 1024;
+
+    struct Stats
+    {
+        uint64_t allocCount = 0;          // Allocations served since reset
+        uint64_t allocBytes = 0;          // Bytes served since reset
+        uint64_t upstreamAllocCount = 0;  // Heap allocations since reset
+        uint64_t upstreamAllocTotal = 0;  // Heap allocations since creation
+        size_t capacity = 0;              // Bytes owned by the arena
+        size_t highWater = 0;             // Max bytes used in one tick
+    };
+
+    explicit FrameArena(size_t initialCapacity = kDefaultCapacity)
+    {
+        allocBlock(initialCapacity);
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(this);
+    }
+    ~FrameArena()
+    {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex());
+            auto& reg = registry();
+            reg.erase(std::remove(reg.begin(), reg.end(), this), reg.end());
+        }
+        freeBlocks();
+    }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Invalidates every allocation made since the last reset
+    void reset()
+    {
+        const size_t used = usedBytes();
+        stats.highWater = std::max(stats.highWater, used);
+        if (blocks.size() > 1)
+        {
+            const size_t newCapacity = std::max(stats.capacity, 2 * used);
+            freeBlocks();
+            allocBlock(newCapacity);
+        }
+        offset = 0;
+        stats.allocCount = 0;
+        stats.allocBytes = 0;
+        stats.upstreamAllocCount = 0;
+    }
+
+    const Stats& getStats() const
+    {
+        return stats;
+    }
+
+    // Arena of the calling thread
+    static FrameArena& local()
+    {
+        thread_local FrameArena arena;
+        return arena;
+    }
+
+    // Resets the arenas of all threads. Must only be called at a barrier
+    // where no other thread allocates, e.g. after the world update joined.
+    static void resetAll()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto* arena : registry())
+        {
+            arena->reset();
+        }
+    }
+
+    // Sum of all thread arenas, same barrier rules as resetAll()
+    static Stats collectStats()
+    {
+        Stats total;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (auto* arena : registry())
+        {
+            const Stats& s = arena->getStats();
+            total.allocCount += s.allocCount;
+            total.allocBytes += s.allocBytes;
+            total.upstreamAllocCount += s.upstreamAllocCount;
+            total.upstreamAllocTotal += s.upstreamAllocTotal;
+            total.capacity += s.capacity;
+            total.highWater += s.highWater;
+        }
+        return total;
+    }
+
+  protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        stats.allocCount++;
+        stats.allocBytes += bytes;
+        Block* block = &blocks.back();
+        size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes > block->size)
+        {
+            allocBlock(std::max(block->size, bytes + alignment));
+            block = &blocks.back();
+            aligned = (offset + alignment - 1) & ~(alignment - 1);
+        }
+        offset = aligned + bytes;
+        return block->data + aligned;
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+        override
+    {
+        return this == &other;
+    }
+
+  private:
+    struct Block
+    {
+        std::byte* data;
+        size_t size;
+    };
+
+    void allocBlock(size_t size)
+    {
+        blocks.push_back({static_cast<std::byte*>(::operator new(
+                              size, std::align_val_t{alignof(max_align_t)})),
+                          size});
+        offset = 0;
+        stats.capacity += size;
+        stats.upstreamAllocCount++;
+        stats.upstreamAllocTotal++;
+    }
+    void freeBlocks()
+    {
+        for (auto& block : blocks)
+        {
+            ::operator delete(block.data,
+                              std::align_val_t{alignof(max_align_t)});
+        }
+        blocks.clear();
+        stats.capacity = 0;
+    }
+    size_t usedBytes() const
+    {
+        size_t used = offset;
+        for (size_t i = 0; i + 1 < blocks.size(); ++i)
+        {
+            used += blocks[i].size;
+        }
+        return used;
+    }
+
+    static std::vector<FrameArena*>& registry()
+    {
+        static std::vector<FrameArena*> arenas;
+        return arenas;
+    }
+    static std::mutex& registryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::vector<Block> blocks;
+    size_t offset = 0;
+    Stats stats;
+};
+
+}  // namespace con::alloc
+
+#endif
@@ -82,8 +82,10 @@ template <class T> class FreeVec
     virtual ~FreeVec() {}
 
     Handle addItem(const T& item);
+    Handle addItem(T&& item);
     void removeItem(int idx);
     void removeItem(Handle handle);
+    template <typename F> void forEach(F&& clb);
     void foreach (std::function<FreeVecForeachRet(T&, Handle)> clb);
 
     T* getItem(int idx, bool getCorpse = false);
@@ -147,6 +149,26 @@ template <class T> FreeVec<T>::Handle FreeVec<T>::addItem(const T& item)
     return Handle(idx, items[idx].generation);
 }
 
+template <class T> FreeVec<T>::Handle FreeVec<T>::addItem(T&& item)
+{
+    int idx;
+    if (freeSlots.empty())
+    {
+        items.push_back({std::move(item), true, 1});
+        idx = items.size() - 1;
+    }
+    else
+    {
+        idx = freeSlots.back();
+        freeSlots.pop_back();
+        items[idx].item = std::move(item);
+        items[idx].alive = true;
+        items[idx].generation++;
+    }
+
+    return Handle(idx, items[idx].generation);
+}
+
 template <class T> FreeVec<T>::Handle FreeVec<T>::firstAliveHandle() const
 {
     for (int i = 0; i < items.size(); ++i)
@@ -161,6 +183,11 @@ template <class T> FreeVec<T>::Handle FreeVec<T>::firstAliveHandle() const
 
 template <class T>
 void FreeVec<T>::foreach (std::function<FreeVecForeachRet(T&, Handle)> clb)
+{
+    forEach(clb);
+}
+
+template <class T> template <typename F> void FreeVec<T>::forEach(F&& clb)
 {
     for (uint32_t i = 0; i < items.size(); ++i)
     {
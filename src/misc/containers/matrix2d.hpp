@@ -1,27 +1,64 @@
 #ifndef MATRIX2D_HPP
 #define MATRIX2D_HPP
 
+#include <algorithm>
 #include <functional>
+#include <numeric>
 #include <std-inc.hpp>
 #include <world-def.hpp>
 
 namespace con
 {
 
+// Memory order of the cells. Indices (coordToIdx) are always row-major, the
+// layout only decides where a cell is stored. Morton keeps 2D neighbours
+// close in memory and in iteration order.
+enum class MatrixLayout
+{
+    RowMajor,
+    Morton,
+};
+
 template <class T> struct Matrix2D
 {
   public:
     Matrix2D() : width(0), height(0), size(0) {}
 
-    void init(uint32_t width, uint32_t height)
+    void init(uint32_t width,
+              uint32_t height,
+              MatrixLayout layout = MatrixLayout::RowMajor)
     {
         this->width = width;
         this->height = height;
         this->size = width * height;
+        this->layout = layout;
         // Sector holds entt::registry and is neither copyable nor movable.
         // Construct a fresh vector in one allocation, then move-assign the
         // container (not the elements) to avoid relocating existing items.
         data = std::vector<T>(size);
+
+        idToSlot.clear();
+        slotToId.clear();
+        if (layout == MatrixLayout::Morton)
+        {
+            // Rank cells by morton code, compacts the code space for sizes
+            // which are not a power of two
+            slotToId.resize(size);
+            std::iota(slotToId.begin(), slotToId.end(), 0);
+            std::sort(slotToId.begin(),
+                      slotToId.end(),
+                      [this](uint32_t a, uint32_t b)
+                      {
+                          return mortonCode(a % this->width, a / this->width)
+                                 < mortonCode(b % this->width,
+                                              b / this->width);
+                      });
+            idToSlot.resize(size);
+            for (uint32_t slot = 0; slot < size; ++slot)
+            {
+                idToSlot[slotToId[slot]] = slot;
+            }
+        }
     }
 
     T* at(uint32_t x, uint32_t y)
@@ -29,7 +66,7 @@ template <class T> struct Matrix2D
         if (x < width && y < height)
         {
             uint32_t idx = coordToIdx(x, y);
-            return &data[idx];
+            return &data[idxToSlot(idx)];
         }
         else
         {
@@ -41,7 +78,7 @@ template <class T> struct Matrix2D
     {
         if (idx < size)
         {
-            return &data[idx];
+            return &data[idxToSlot(idx)];
         }
         else
         {
@@ -49,16 +86,36 @@ template <class T> struct Matrix2D
         }
     }
 
+    // Iterates in memory order, passes the row-major index
     void iterateContent(std::function<void(uint32_t, T*)> clb)
     {
         if (!clb)
             return;
-        for (uint32_t id = 0; id < size; ++id)
+        for (uint32_t slot = 0; slot < size; ++slot)
         {
-            clb(id, &data[id]);
+            clb(slotToIdx(slot), &data[slot]);
         }
     }
 
+    // Position of a cell in memory order
+    uint32_t idxToSlot(uint32_t idx) const
+    {
+        return idToSlot.empty() ? idx : idToSlot[idx];
+    }
+    uint32_t slotToIdx(uint32_t slot) const
+    {
+        return slotToId.empty() ? slot : slotToId[slot];
+    }
+    MatrixLayout getLayout() const
+    {
+        return layout;
+    }
+
+    static uint32_t mortonCode(uint32_t x, uint32_t y)
+    {
+        return spreadBits(x) | (spreadBits(y) << 1);
+    }
+
     uint32_t getWidth() const
     {
         return width;
@@ -147,10 +204,24 @@ template <class T> struct Matrix2D
     }
 
   private:
+    // Inserts a zero bit between each of the lower 16 bits
+    static uint32_t spreadBits(uint32_t v)
+    {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
     uint32_t width;
     uint32_t height;
     uint32_t size;
+    MatrixLayout layout = MatrixLayout::RowMajor;
     std::vector<T> data;
+    std::vector<uint32_t> idToSlot;
+    std::vector<uint32_t> slotToId;
 };
 
 }  // namespace con
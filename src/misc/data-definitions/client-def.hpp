@@ -14,6 +14,14 @@ namespace def
 #define CLIENT_FLAG_EN_CONSOLE 1 << 0
 static constexpr size_t CLIENT_INFO_NAME_MAX = 256;
 
+#ifdef SERVER
+struct SectorDumpState
+{
+    uint32_t lastSentFrame = 0;
+    long lastFullDump = 0;
+};
+#endif
+
 class ClientInfo
 {
   public:
@@ -47,6 +55,7 @@ class ClientInfo
     net::ClientInfo clientInfo;
     long lastSlowDump;
     long lastActiveSectorDump;
+    std::unordered_map<uint32_t, SectorDumpState> sectorDumpStates;
     ThirdPersonControl thirdPersonControl;
 
     void addWorkFunction(work::WorkFunction workFunction)
@@ -0,0 +1,18 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstdint>
+
+namespace con::alloc
+{
+
+// Only built with the SPHY_COUNT_HEAP_ALLOCS CMake option, which replaces the
+// global operator new. Calls of the global operator new (plain and array forms) since process
+// start, from all threads. The counter is one relaxed atomic increment per
+// allocation. Over-aligned allocations are not counted, the frame arena
+// counts its own blocks.
+uint64_t heapAllocCount();
+
+}  // namespace con::alloc
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef FUNCTION_REF_HPP
+#define FUNCTION_REF_HPP
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace con
+{
+
+template <class Signature> class FunctionRef;
+
+// Non owning reference to a callable. Two pointers, never allocates and
+// costs one indirect call, unlike std::function it must not outlive the
+// callable it was created from. Use it for callback parameters that are only
+// invoked during the call.
+template <class Ret, class... Args> class FunctionRef<Ret(Args...)>
+{
+  public:
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef>
+                 && std::is_invocable_r_v<Ret, F&, Args...>)
+    FunctionRef(F&& f) noexcept
+        : obj(const_cast<void*>(
+              static_cast<const void*>(std::addressof(f)))),
+          callback(
+              [](void* o, Args... args) -> Ret
+              {
+                  return (*static_cast<std::add_pointer_t<F>>(o))(
+                      std::forward<Args>(args)...);
+              })
+    {
+    }
+    FunctionRef(const FunctionRef&) = default;
+    FunctionRef& operator=(const FunctionRef&) = default;
+
+    Ret operator()(Args... args) const
+    {
+        return callback(obj, std::forward<Args>(args)...);
+    }
+
+  private:
+    void* obj;
+    Ret (*callback)(void*, Args...);
+};
+
+}  // namespace con
+
+#endif
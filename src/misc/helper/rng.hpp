@@ -0,0 +1,76 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+
+namespace con
+{
+
+// Counter based random numbers: the n-th number of a stream is a hash of
+// (key, n), the splitmix64 finalizer over a Weyl sequence. There is no shared
+// state and no lock, a stream keyed by seed, sector and tick yields the same
+// numbers on whatever thread runs the sector, so ticks can be replayed.
+// Not for anything security related.
+class Rng
+{
+  public:
+    explicit Rng(uint64_t key = 0) : key(key) {}
+
+    static uint64_t makeKey(uint64_t seed, uint32_t stream, uint32_t tick)
+    {
+        return mix(seed ^ mix((uint64_t(stream) << 32) | tick));
+    }
+    void reset(uint64_t key)
+    {
+        this->key = key;
+        counter = 0;
+    }
+    // Independent stream for a sub id (e.g. an entity), does not advance
+    // this one. Its numbers do not depend on the order the ids are served.
+    Rng fork(uint32_t id) const
+    {
+        return Rng(mix(key ^ (uint64_t(id) * kWeyl + kWeyl)));
+    }
+
+    uint32_t next()
+    {
+        return uint32_t(mix(key + ++counter * kWeyl) >> 32);
+    }
+    // [0, n), multiply-shift instead of modulo
+    uint32_t below(uint32_t n)
+    {
+        return uint32_t((uint64_t(next()) * n) >> 32);
+    }
+    // [lo, hi)
+    int32_t range(int32_t lo, int32_t hi)
+    {
+        return lo + int32_t(below(uint32_t(hi - lo)));
+    }
+    // [0, 1)
+    float uniform()
+    {
+        return float(next() >> 8) * 0x1p-24f;
+    }
+    // [lo, hi)
+    float uniform(float lo, float hi)
+    {
+        return lo + (hi - lo) * uniform();
+    }
+
+  private:
+    static constexpr uint64_t kWeyl = 0x9e3779b97f4a7c15ULL;
+
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t key;
+    uint64_t counter = 0;
+};
+
+}  // namespace con
+
+#endif
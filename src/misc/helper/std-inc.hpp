@@ -36,6 +36,7 @@
 #include <logging.hpp>
 #include <memory.h>
 #include <optional>
+#include <span>
 #include <string>
 #include <variant>
 #include <yaml-cpp/yaml.h>
@@ -349,7 +350,22 @@ inline float between(float d, float min, float max)
 
 inline float angleError(float target, float current)
 {
-    float error = fmodf(target - current + M_PI, 2.0f * M_PI);
+    float error = target - current;
+    // Callers mostly pass wrapped angles, a difference within one turn of
+    // [-pi, pi) is wrapped without fmodf
+    if (error >= -3.0f * M_PIf && error < 3.0f * M_PIf)
+    {
+        if (error >= M_PIf)
+        {
+            error -= 2.0f * M_PIf;
+        }
+        else if (error < -M_PIf)
+        {
+            error += 2.0f * M_PIf;
+        }
+        return error;
+    }
+    error = fmodf(error + M_PI, 2.0f * M_PI);
     if (error < 0)
         error += 2.0f * M_PI;
     return error - M_PI;
@@ -381,6 +397,31 @@ inline vec2 rotateVec2(const vec2& v, float radians)
     return rotateVec2(v, std::sin(radians), std::cos(radians));
 }
 
+// Advances the unit complex (c, s) of an angle by dAngle without trig: the
+// rotation exp(i * dAngle) is a Taylor polynomial, good for the small steps
+// of one tick, and one Newton step pulls the length back to 1. Larger steps
+// fall back to cosf / sinf.
+inline void rotateUnit(float& c, float& s, float dAngle)
+{
+    float rc, rs;
+    if (fabsf(dAngle) < 0.25f)
+    {
+        const float a2 = dAngle * dAngle;
+        rc = 1.0f - a2 * (0.5f - a2 * (1.0f / 24.0f));
+        rs = dAngle * (1.0f - a2 * (1.0f / 6.0f - a2 * (1.0f / 120.0f)));
+    }
+    else
+    {
+        rc = cosf(dAngle);
+        rs = sinf(dAngle);
+    }
+    const float nc = c * rc - s * rs;
+    const float ns = s * rc + c * rs;
+    const float k = 1.5f - 0.5f * (nc * nc + ns * ns);
+    c = nc * k;
+    s = ns * k;
+}
+
 inline vec2 perpVec2(vec2 vec)
 {
     return vec2(-vec.y, vec.x);
@@ -515,7 +556,7 @@ struct formatter<std::vector<T, Allocator>>
 
 namespace sat2d
 {
-inline void projectOntoAxis(const std::vector<vec2>& poly,
+inline void projectOntoAxis(std::span<const vec2> poly,
                             const vec2& axis,
                             float& outMin,
                             float& outMax)
@@ -529,7 +570,7 @@ inline void projectOntoAxis(const std::vector<vec2>& poly,
     }
 }
 
-inline vec2 centroid(const std::vector<vec2>& poly)
+inline vec2 centroid(std::span<const vec2> poly)
 {
     vec2 sum(0.0f);
     for (const vec2& v : poly)
@@ -540,7 +581,7 @@ inline vec2 centroid(const std::vector<vec2>& poly)
 }
 
 // Convex polygon only; vertices in consistent winding (CW or CCW).
-inline bool pointInConvex(const vec2& p, const std::vector<vec2>& poly)
+inline bool pointInConvex(const vec2& p, std::span<const vec2> poly)
 {
     const size_t n = poly.size();
     if (n < 3)
@@ -572,7 +613,7 @@ inline bool pointInConvex(const vec2& p, const std::vector<vec2>& poly)
     return true;
 }
 
-inline float convexPolygonArea(const std::vector<vec2>& poly)
+inline float convexPolygonArea(std::span<const vec2> poly)
 {
     const size_t n = poly.size();
     if (n < 3)
@@ -589,8 +630,8 @@ inline float convexPolygonArea(const std::vector<vec2>& poly)
     return 0.5f * std::fabs(twice);
 }
 
-inline bool intervalsOverlapOnAxis(const std::vector<vec2>& a,
-                                   const std::vector<vec2>& b,
+inline bool intervalsOverlapOnAxis(std::span<const vec2> a,
+                                   std::span<const vec2> b,
                                    const vec2& axis,
                                    float eps)
 {
@@ -603,8 +644,8 @@ inline bool intervalsOverlapOnAxis(const std::vector<vec2>& a,
     return !(amax < bmin - eps || bmax < amin - eps);
 }
 
-inline bool testAxesFromPolygon(const std::vector<vec2>& polyA,
-                                const std::vector<vec2>& polyB)
+inline bool testAxesFromPolygon(std::span<const vec2> polyA,
+                                std::span<const vec2> polyB)
 {
     constexpr float kEpsLenSq = 1e-12f;
     constexpr float kEpsSep = 1e-6f;
@@ -631,8 +672,8 @@ inline bool testAxesFromPolygon(const std::vector<vec2>& polyA,
 // Separating axis + minimum penetration (MTV length along chosen unit normal).
 // On success, outNormal points from polygon a toward polygon b; outPenetration
 // is positive overlap along that normal (world units if vertices are world).
-inline bool convexConvexMTV(const std::vector<vec2>& a,
-                            const std::vector<vec2>& b,
+inline bool convexConvexMTV(std::span<const vec2> a,
+                            std::span<const vec2> b,
                             vec2& outNormalAToB,
                             float& outPenetration)
 {
@@ -650,8 +691,8 @@ inline bool convexConvexMTV(const std::vector<vec2>& a,
     float minOverlap = std::numeric_limits<float>::max();
     vec2 bestN(1.0f, 0.0f);
 
-    const auto considerAxes = [&](const std::vector<vec2>& polyA,
-                                  const std::vector<vec2>& polyB) -> bool
+    const auto considerAxes = [&](std::span<const vec2> polyA,
+                                  std::span<const vec2> polyB) -> bool
     {
         const size_t n = polyA.size();
         for (size_t i = 0; i < n; ++i)
@@ -707,7 +748,7 @@ inline bool convexConvexMTV(const std::vector<vec2>& a,
     return true;
 }
 
-inline bool convexConvex(const std::vector<vec2>& a, const std::vector<vec2>& b)
+inline bool convexConvex(std::span<const vec2> a, std::span<const vec2> b)
 {
     vec2 n;
     float pen;
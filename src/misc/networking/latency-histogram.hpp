@@ -0,0 +1,67 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <bit>
+#include <std-inc.hpp>
+
+namespace net
+{
+
+// Power of two buckets of microseconds, bucket i counts samples below 2^i
+// us. Not thread safe, meant to be owned by the thread that records.
+class LatencyHistogram
+{
+  public:
+    static constexpr int kNumBuckets = 24;
+
+    void add(long us)
+    {
+        us = std::max(us, 0L);
+        const int bucket = std::min<int>(
+            std::bit_width(static_cast<unsigned long>(us)), kNumBuckets - 1);
+        buckets[bucket]++;
+        numSamples++;
+        maxU = std::max(maxU, us);
+    }
+    // Upper bound of the bucket holding the p-th sample, p in [0, 1]
+    long percentile(float p) const
+    {
+        const uint64_t rank = static_cast<uint64_t>(p * numSamples);
+        uint64_t seen = 0;
+        for (int i = 0; i < kNumBuckets; i++)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+            {
+                return 1L << i;
+            }
+        }
+        return maxU;
+    }
+    uint64_t count() const
+    {
+        return numSamples;
+    }
+    void reset()
+    {
+        *this = LatencyHistogram();
+    }
+    std::string toString() const
+    {
+        return fmt::format("n={} p50<{}us p90<{}us p99<{}us max={}us",
+                           numSamples,
+                           percentile(0.5f),
+                           percentile(0.9f),
+                           percentile(0.99f),
+                           maxU);
+    }
+
+  private:
+    std::array<uint64_t, kNumBuckets> buckets = {};
+    uint64_t numSamples = 0;
+    long maxU = 0;
+};
+
+}  // namespace net
+
+#endif
@@ -0,0 +1,60 @@
+#include "msg-buffer.hpp"
+
+namespace net
+{
+
+void MsgBuffer::reset()
+{
+    if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        BufferPool::global().recycle(node);
+    }
+    node = nullptr;
+}
+
+BufferPool& BufferPool::global()
+{
+    static BufferPool pool;
+    return pool;
+}
+
+BufferPool::~BufferPool()
+{
+    MsgBuffer::Node* node;
+    while (freeNodes.try_dequeue(node))
+    {
+        delete node;
+    }
+}
+
+MsgBuffer BufferPool::acquire()
+{
+    MsgBuffer::Node* node;
+    if (!freeNodes.try_dequeue(node))
+    {
+        node = new MsgBuffer::Node();
+    }
+    return MsgBuffer(node);
+}
+
+MsgBuffer BufferPool::adopt(Buffer&& data)
+{
+    MsgBuffer msg = acquire();
+    msg.get() = std::move(data);
+    return msg;
+}
+
+void BufferPool::recycle(MsgBuffer::Node* node)
+{
+    if (node->data.capacity() > kMaxKeptCapacity
+        || freeNodes.size_approx() >= kMaxFreeBuffers)
+    {
+        delete node;
+        return;
+    }
+    node->data.clear();
+    node->refs.store(1, std::memory_order_relaxed);
+    freeNodes.enqueue(node);
+}
+
+}  // namespace net
@@ -0,0 +1,92 @@
+#ifndef MSG_BUFFER_HPP
+#define MSG_BUFFER_HPP
+
+#include <atomic>
+#include <std-inc.hpp>
+
+namespace net
+{
+
+// Reference counted handle to a pooled byte buffer. A message is written
+// into it once and then handed from the composer over the send queue to the
+// socket by moving the handle, the bytes are never copied. The buffer goes
+// back to the pool when the last handle is gone, for async sends that is the
+// copy held by the completion handler.
+class MsgBuffer
+{
+  public:
+    MsgBuffer() = default;
+    MsgBuffer(const MsgBuffer& other) : node(other.node)
+    {
+        if (node)
+        {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    MsgBuffer(MsgBuffer&& other) noexcept
+        : node(std::exchange(other.node, nullptr))
+    {
+    }
+    MsgBuffer& operator=(MsgBuffer other) noexcept
+    {
+        std::swap(node, other.node);
+        return *this;
+    }
+    ~MsgBuffer()
+    {
+        reset();
+    }
+
+    void reset();
+    Buffer& get()
+    {
+        return node->data;
+    }
+    const Buffer& get() const
+    {
+        return node->data;
+    }
+    explicit operator bool() const
+    {
+        return node != nullptr;
+    }
+
+  private:
+    friend class BufferPool;
+    struct Node
+    {
+        Buffer data;
+        std::atomic<uint32_t> refs{1};
+    };
+    explicit MsgBuffer(Node* node) : node(node) {}
+
+    Node* node = nullptr;
+};
+
+// Free list of message buffers shared by all threads. Buffers keep their
+// capacity while pooled, oversized ones are dropped so a single large dump
+// does not pin its memory.
+class BufferPool
+{
+  public:
+    static constexpr size_t kMaxKeptCapacity = 64 * 1024;
+    static constexpr size_t kMaxFreeBuffers = 1024;
+
+    static BufferPool& global();
+    ~BufferPool();
+
+    // Empty buffer, capacity from an earlier message if one was free
+    MsgBuffer acquire();
+    // Moves data into a pooled buffer
+    MsgBuffer adopt(Buffer&& data);
+
+  private:
+    friend class MsgBuffer;
+    void recycle(MsgBuffer::Node* node);
+
+    ConcurrentQueue<MsgBuffer::Node*> freeNodes;
+};
+
+}  // namespace net
+
+#endif
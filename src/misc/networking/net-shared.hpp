@@ -1,6 +1,7 @@
 #ifndef NET_SHARED_HPP
 #define NET_SHARED_HPP
 
+#include <msg-buffer.hpp>
 #include <std-inc.hpp>
 
 namespace net
@@ -33,8 +34,27 @@ struct CmdQueueData
     udp::endpoint udpEndpoint;
     TcpConnection* tcpConnection = nullptr;
     std::vector<uint8_t> data;
+    // Composed outgoing message, empty if the message was built in data
+    MsgBuffer msg;
     bool tcpDisconnected = false;
     uint32_t tcpDisconnectedHandleValue = 0;
+    // tim::nowU() when the message was put on the send queue
+    long enqueueU = 0;
+
+    // The bytes to send, wherever the message was built
+    Buffer& payload()
+    {
+        return msg ? msg.get() : data;
+    }
+    // Hands the payload on as a pooled buffer
+    MsgBuffer takeMsg()
+    {
+        if (!msg)
+        {
+            return BufferPool::global().adopt(std::move(data));
+        }
+        return std::move(msg);
+    }
 };
 
 typedef std::function<void(const net::CmdQueueData&)> TcpReceiveClb;
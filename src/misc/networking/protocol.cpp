@@ -18,6 +18,7 @@ void writeMessageUdp(ConcurrentQueue<net::CmdQueueData>& sendQueue,
     }
     if (writeMessage(cmdData, contentWriter, useToken, removeTrailingBytes))
     {
+        cmdData.enqueueU = tim::nowU();
         sendQueue.enqueue(cmdData);
     }
 }
@@ -31,6 +32,7 @@ void writeMessageTcp(ConcurrentQueue<net::CmdQueueData>& sendQueue,
     cmdData.tcpConnection = tcpConnection;
     if (writeMessage(cmdData, contentWriter))
     {
+        cmdData.enqueueU = tim::nowU();
         sendQueue.enqueue(cmdData);
     }
 }
@@ -103,15 +105,6 @@ MsgComposer::MsgComposer(net::SendType type,
     resetData();
 }
 
-MsgComposer::~MsgComposer()
-{
-    if (ser)
-    {
-        delete ser;
-        ser = nullptr;
-    }
-}
-
 void MsgComposer::startCommand(uint16_t cmd, uint8_t flags)
 {
     if(!cmdFinished)
@@ -135,8 +128,12 @@ void MsgComposer::execute(ConcurrentQueue<net::CmdQueueData>& sendQueue)
         {
             finishCommand();
         }
-        cmdData.data.resize(ser->adapter().currentWritePos());
-        sendQueue.enqueue(cmdData);
+        msg.get().resize(ser->adapter().currentWritePos());
+        net::CmdQueueData out = cmdData;
+        out.msg = std::move(msg);
+        out.enqueueU = tim::nowU();
+        sendQueue.enqueue(std::move(out));
+        resetData();
     }
 }
 
@@ -158,13 +155,13 @@ void MsgComposer::finishCommand()
 
 void MsgComposer::resetData()
 {
-    if (ser)
+    if (!msg)
     {
-        delete ser;
-        ser = nullptr;
-        cmdData.data.clear();
+        msg = net::BufferPool::global().acquire();
     }
-    ser = new bitsery::Serializer<OutputAdapter>(OutputAdapter(cmdData.data));
+    msg.get().clear();
+    // The adapter caches the buffer pointers, so it is rebuilt as well
+    ser = &serStorage.emplace(OutputAdapter(msg.get()));
     hasContent = false;
     cmdFinished = true;
 }
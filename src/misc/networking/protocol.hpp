@@ -80,15 +80,20 @@ class MsgComposer
   public:
     MsgComposer(net::SendType type, const udp::endpoint& endpoint, bool useToken = true);
     MsgComposer(net::SendType type, net::TcpConnection* tcpConnection);
-    ~MsgComposer();
+    MsgComposer(const MsgComposer&) = delete;
+    MsgComposer& operator=(const MsgComposer&) = delete;
     void resetData();
     void startCommand(uint16_t cmd, uint8_t flags);
+    // Hands the written buffer to the send queue and starts an empty one
     void execute(ConcurrentQueue<net::CmdQueueData>& sendQueue);
     bool hasData() const { return hasContent; }
     bitsery::Serializer<OutputAdapter>* ser = nullptr;
   private:
     void finishCommand();
     net::CmdQueueData cmdData;
+    net::MsgBuffer msg;
+    // ser points in here, rebuilt in place for every message
+    std::optional<bitsery::Serializer<OutputAdapter>> serStorage;
     size_t currCmdPos = 0;
     size_t currLenPos = 0;
     bool hasContent = false;
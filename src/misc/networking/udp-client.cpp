@@ -26,16 +26,18 @@ void UdpClient::close()
     [[maybe_unused]] const auto closed = socket.close(ec);
 }
 
-void UdpClient::sendMessage(const std::vector<uint8_t>& data)
+void UdpClient::sendMessage(MsgBuffer msg)
 {
     if (!running.load())
     {
         return;
     }
+    const auto buffer = boost::asio::buffer(msg.get());
     socket.async_send_to(
-        boost::asio::buffer(data),
+        buffer,
         devServerEndpoint,
-        [this](const boost::system::error_code& ec, std::size_t bytes)
+        [msg = std::move(msg)](const boost::system::error_code& ec,
+                               std::size_t bytes)
         {
             if (ec)
             {
@@ -18,7 +18,8 @@ class UdpClient
               ReceiveCallback receiveCallback);
     void close();
 
-    void sendMessage(const std::vector<uint8_t>& data);
+    // msg is kept alive by the completion handler until the send is done
+    void sendMessage(MsgBuffer msg);
 
     void sendMessageTo(udp::endpoint endpoint, const std::vector<uint8_t> data);
 
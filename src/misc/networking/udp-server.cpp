@@ -70,13 +70,14 @@ void UdpServer::handleReceive(const boost::system::error_code& error,
     startReceive();
 }
 
-void UdpServer::sendMessage(udp::endpoint endpoint,
-                            const std::vector<uint8_t>& data)
+void UdpServer::sendMessage(udp::endpoint endpoint, MsgBuffer msg)
 {
+    const auto buffer = boost::asio::buffer(msg.get());
     socket_.async_send_to(
-        boost::asio::buffer(data),
+        buffer,
         endpoint,
-        [this, endpoint](const boost::system::error_code& ec, std::size_t bytes)
+        [msg = std::move(msg)](const boost::system::error_code& ec,
+                               std::size_t bytes)
         {
             if (ec)
             {
@@ -17,7 +17,8 @@ class UdpServer
               ReceiveCallback receiveCallback);
     ~UdpServer();
     void close();
-    void sendMessage(udp::endpoint endpoint, const std::vector<uint8_t>& data);
+    // msg is kept alive by the completion handler until the send is done
+    void sendMessage(udp::endpoint endpoint, MsgBuffer msg);
 
   private:
     void startReceive();
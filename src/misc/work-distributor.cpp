@@ -1,8 +1,18 @@
 #include "work-distributor.hpp"
+#include <algorithm>
+#include <memory>
 
 namespace sthread
 {
 
+namespace
+{
+
+// Worker index of the calling thread, -1 outside the workers
+thread_local int currentThreadId = -1;
+
+}  // namespace
+
 WorkDistributor::WorkDistributor() {};
 
 WorkDistributor::~WorkDistributor()
@@ -67,6 +77,7 @@ void WorkDistributor::addWork(WorkFunction work, int preferredThreadId)
 
 void WorkDistributor::run(int threadId)
 {
+    currentThreadId = threadId;
     while (true)
     {
         WorkFunction work;
@@ -107,6 +118,63 @@ void WorkDistributor::waitForEmptyQueues()
                  { return pendingTasks.load(std::memory_order_acquire) == 0; });
 }
 
+void WorkDistributor::parallelFor(size_t count,
+                                  con::FunctionRef<void(size_t)> fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    const size_t numQueues = workQueues.size();
+    const size_t numHelpers = std::min(count, numQueues + 1) - 1;
+    if (numHelpers == 0)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            fn(i);
+        }
+        return;
+    }
+    auto state = std::make_shared<ForkState>(count, fn);
+    // Explicit queues, addWork's round robin counter is not thread safe.
+    // The own queue comes last, its helper would only run after this call.
+    const size_t self = currentThreadId < 0 ? numQueues : currentThreadId;
+    for (size_t i = 0; i < numHelpers; i++)
+    {
+        const size_t queueIdx = (self + 1 + i) % numQueues;
+        workQueues[queueIdx].enqueue([state]() { runForkState(*state); });
+        pendingTasks.fetch_add(1, std::memory_order_release);
+    }
+    {
+        // Under the lock, so an idle worker can not miss the wakeup
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    stateCv.notify_all();
+
+    runForkState(*state);
+    size_t done = state->done.load(std::memory_order_acquire);
+    while (done != count)
+    {
+        state->done.wait(done, std::memory_order_acquire);
+        done = state->done.load(std::memory_order_acquire);
+    }
+}
+
+void WorkDistributor::runForkState(ForkState& state)
+{
+    size_t i;
+    while ((i = state.next.fetch_add(1, std::memory_order_relaxed))
+           < state.count)
+    {
+        state.fn(i);
+        if (state.done.fetch_add(1, std::memory_order_acq_rel) + 1
+            == state.count)
+        {
+            state.done.notify_all();
+        }
+    }
+}
+
 size_t WorkDistributor::getThreadCount() const
 {
     return threads.size();
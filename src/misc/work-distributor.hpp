@@ -4,6 +4,7 @@
 #include <concurrentqueue.h>
 #include <atomic>
 #include <condition_variable>
+#include <function-ref.hpp>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -26,8 +27,29 @@ class WorkDistributor
     void suspend();
     void addWork(WorkFunction work, int preferredThreadId = -1);
     void waitForEmptyQueues();
+    // Fork-join: calls fn(0) ... fn(count - 1) on the calling thread and on
+    // the other workers and returns once every call returned. Meant for work
+    // functions that split their own work. The caller takes indices itself
+    // until none are left, so it never waits for a worker that is busy with
+    // other work, it only waits for calls already running elsewhere.
+    void parallelFor(size_t count, con::FunctionRef<void(size_t)> fn);
     size_t getThreadCount() const;
   private:
+    // Shared by the caller and the helpers of one parallelFor. Helpers that
+    // only start after the caller returned find no index left and never
+    // touch fn, so the state must outlive the call but fn need not.
+    struct ForkState
+    {
+        ForkState(size_t count, con::FunctionRef<void(size_t)> fn)
+            : count(count), fn(fn)
+        {
+        }
+        const size_t count;
+        con::FunctionRef<void(size_t)> fn;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+    };
+    static void runForkState(ForkState& state);
     void run(int threadId);
 
     std::vector<std::thread> threads;
@@ -0,0 +1,234 @@
+#include "bench-util.hpp"
+#include "std-inc.hpp"
+#include <entt/entt.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace
+{
+
+// Layout mirrors of the physics components, the real ones pull in the whole
+// game object library
+struct Transform
+{
+    vec2 pos;
+    float rot;
+};
+struct TransformCache
+{
+    float c;
+    float s;
+};
+struct PhysicsBody
+{
+    vec2 vel;
+    vec2 acc;
+    float rotVel;
+    float rotAcc;
+    float mass;
+    float inertia;
+    float naturalRotation;
+};
+struct EntityId
+{
+    uint32_t id;
+};
+struct SectorId
+{
+    uint32_t id;
+};
+struct Broadphase
+{
+    int32_t proxyId;
+};
+// Components without physics, they interleave the pools like modules and
+// map icons do in a sector
+struct Cold
+{
+    uint32_t data[4];
+};
+
+constexpr int kIterations = 20;
+constexpr float kDt = 0.016f;
+
+using bench::measureU;
+
+void populate(entt::registry& reg, int numEntities, uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<int> kindDist(0, 3);
+    int numBodies = 0;
+    while (numBodies < numEntities)
+    {
+        auto entity = reg.create();
+        reg.emplace<EntityId>(entity, static_cast<uint32_t>(entity));
+        reg.emplace<SectorId>(entity, 0u);
+        // One in four entities is a module or part without a body
+        if (kindDist(gen) == 0)
+        {
+            reg.emplace<Cold>(entity);
+            reg.emplace<Transform>(entity, vec2(dist(gen), dist(gen)), 0.0f);
+            continue;
+        }
+        reg.emplace<Transform>(entity, vec2(dist(gen), dist(gen)), 0.0f);
+        reg.emplace<TransformCache>(entity, 1.0f, 0.0f);
+        reg.emplace<PhysicsBody>(entity,
+                                 vec2(dist(gen), dist(gen)) * 0.01f,
+                                 vec2(0.0f),
+                                 dist(gen) * 0.001f,
+                                 0.0f,
+                                 1.0f,
+                                 1.0f,
+                                 0.0f);
+        reg.emplace<Broadphase>(entity, numBodies);
+        numBodies++;
+    }
+    // Strip and respawn a share of the bodies to scramble the pools
+    std::vector<entt::entity> bodies;
+    for (auto entity : reg.view<PhysicsBody>())
+    {
+        bodies.push_back(entity);
+    }
+    std::shuffle(bodies.begin(), bodies.end(), gen);
+    const size_t numRespawn = bodies.size() / 5;
+    for (size_t i = 0; i < numRespawn; ++i)
+    {
+        const auto body = reg.get<PhysicsBody>(bodies[i]);
+        const auto transform = reg.get<Transform>(bodies[i]);
+        reg.remove<PhysicsBody, TransformCache, Broadphase>(bodies[i]);
+        auto entity = reg.create();
+        reg.emplace<Transform>(entity, transform);
+        reg.emplace<PhysicsBody>(entity, body);
+        reg.emplace<TransformCache>(entity, 1.0f, 0.0f);
+        reg.emplace<Broadphase>(entity, static_cast<int32_t>(i));
+        reg.emplace<SectorId>(entity, 0u);
+        reg.emplace<EntityId>(entity, static_cast<uint32_t>(entity));
+    }
+}
+
+// Same arithmetic as sysPhysicsImpl minus the collider and sector checks
+void integrate(Transform& transform,
+               TransformCache& transformCache,
+               PhysicsBody& physicsBody,
+               const SectorId& sectorId,
+               Broadphase& broadphase)
+{
+    physicsBody.acc += -0.1f * physicsBody.vel;
+    physicsBody.rotAcc +=
+        -0.1f * (physicsBody.rotVel - physicsBody.naturalRotation);
+    physicsBody.vel += physicsBody.acc * kDt;
+    physicsBody.rotVel += physicsBody.rotAcc * kDt;
+    transform.rot += physicsBody.rotVel * kDt;
+    transformCache.c = cosf(transform.rot);
+    transformCache.s = sinf(transform.rot);
+    transform.pos += physicsBody.vel * kDt;
+    physicsBody.acc = {0, 0};
+    physicsBody.rotAcc = 0;
+    broadphase.proxyId += sectorId.id;
+}
+
+void benchEntityCount(int numEntities)
+{
+    entt::registry viewReg;
+    entt::registry groupReg;
+    populate(viewReg, numEntities, 11);
+    populate(groupReg, numEntities, 11);
+    // Created after the pools were filled, like a group over a live sector
+    auto group = groupReg.group<Transform, TransformCache, PhysicsBody>(
+        entt::get<EntityId, SectorId, Broadphase>);
+
+    long viewU = 0, groupU = 0;
+    for (int iter = 0; iter < kIterations; ++iter)
+    {
+        viewU += measureU(
+            [&]()
+            {
+                viewReg
+                    .view<EntityId,
+                          SectorId,
+                          Transform,
+                          TransformCache,
+                          PhysicsBody,
+                          Broadphase>()
+                    .each(
+                        [](auto entity,
+                           auto& entityId,
+                           auto& sectorId,
+                           auto& transform,
+                           auto& transformCache,
+                           auto& physicsBody,
+                           auto& broadphase)
+                        {
+                            integrate(transform,
+                                      transformCache,
+                                      physicsBody,
+                                      sectorId,
+                                      broadphase);
+                        });
+            });
+        groupU += measureU(
+            [&]()
+            {
+                group.each(
+                    [](auto entity,
+                       auto& transform,
+                       auto& transformCache,
+                       auto& physicsBody,
+                       auto& entityId,
+                       auto& sectorId,
+                       auto& broadphase)
+                    {
+                        integrate(transform,
+                                  transformCache,
+                                  physicsBody,
+                                  sectorId,
+                                  broadphase);
+                    });
+            });
+    }
+    // Both registries were populated with the same seed, so the entity ids
+    // match and every body must have ended up in the same place
+    ASSERT_EQ(group.size(), numEntities);
+    for (auto [entity, transform] : viewReg.view<Transform>().each())
+    {
+        ASSERT_TRUE(groupReg.valid(entity));
+        EXPECT_EQ(groupReg.get<Transform>(entity).pos, transform.pos);
+    }
+    LG_I("{} bodies: view {} us, owning group {} us per tick",
+         numEntities,
+         viewU / kIterations,
+         groupU / kIterations);
+}
+
+}  // namespace
+
+TEST(EcsGroups, GroupMatchesView)
+{
+    entt::registry reg;
+    populate(reg, 1000, 3);
+    auto group = reg.group<Transform, TransformCache, PhysicsBody>(
+        entt::get<EntityId, SectorId, Broadphase>);
+    size_t viewCount = 0;
+    for ([[maybe_unused]] auto entity :
+         reg.view<Transform, TransformCache, PhysicsBody, Broadphase>())
+    {
+        viewCount++;
+    }
+    EXPECT_EQ(group.size(), viewCount);
+
+    // Entities entering and leaving the group keep the owned pools packed
+    auto entity = *group.begin();
+    reg.remove<PhysicsBody>(entity);
+    EXPECT_EQ(group.size(), viewCount - 1);
+    reg.emplace<PhysicsBody>(entity);
+    EXPECT_EQ(group.size(), viewCount);
+    EXPECT_EQ(reg.storage<Transform>().data()[group.size() - 1], entity);
+}
+
+TEST(EcsGroups, BenchPhysicsIteration)
+{
+    benchEntityCount(1000);
+    benchEntityCount(10000);
+    benchEntityCount(100000);
+}
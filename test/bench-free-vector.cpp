@@ -0,0 +1,170 @@
+#include "bench-util.hpp"
+#include "dense-free-vector.hpp"
+#include "free-vector.hpp"
+#include "std-inc.hpp"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+namespace
+{
+
+struct BenchObj
+{
+    vec2 pos;
+    vec2 vel;
+    float lifetime;
+    float lifetimeMax;
+};
+
+constexpr int kNumObjects = 100000;
+constexpr int kIterations = 50;
+
+using bench::measureU;
+
+BenchObj makeObj(int i)
+{
+    return BenchObj{vec2(i, i), vec2(1.0f, 0.5f), 0.0f, 10.0f};
+}
+
+}  // namespace
+
+TEST(DenseFreeVec, HandlesStayValidAfterSwapRemove)
+{
+    con::DenseFreeVec<int> vec;
+    auto h0 = vec.addItem(0);
+    auto h1 = vec.addItem(1);
+    auto h2 = vec.addItem(2);
+    vec.removeItem(h0);
+    EXPECT_EQ(vec.size(), 2);
+    EXPECT_EQ(vec.getItem(h0), nullptr);
+    ASSERT_NE(vec.getItem(h1), nullptr);
+    ASSERT_NE(vec.getItem(h2), nullptr);
+    EXPECT_EQ(*vec.getItem(h1), 1);
+    EXPECT_EQ(*vec.getItem(h2), 2);
+
+    // Reused slot must not be reachable through the stale handle
+    auto h3 = vec.addItem(3);
+    EXPECT_EQ(h3.getIdx(), h0.getIdx());
+    EXPECT_NE(h3.getGeneration(), h0.getGeneration());
+    EXPECT_EQ(vec.getItem(h0), nullptr);
+    EXPECT_EQ(*vec.getItem(h3), 3);
+}
+
+TEST(DenseFreeVec, ForEachDestroyVisitsEveryItemOnce)
+{
+    con::DenseFreeVec<int> vec;
+    for (int i = 0; i < 100; ++i)
+    {
+        vec.addItem(i);
+    }
+    int visited = 0;
+    vec.forEach(
+        [&visited](int& item, con::DenseFreeVec<int>::Handle)
+        {
+            visited++;
+            return item % 2 == 0 ? con::FreeVecForeachRet::DESTROY
+                                 : con::FreeVecForeachRet::OK;
+        });
+    EXPECT_EQ(visited, 100);
+    EXPECT_EQ(vec.size(), 50);
+    vec.forEach(
+        [](int& item, con::DenseFreeVec<int>::Handle)
+        {
+            EXPECT_EQ(item % 2, 1);
+            return con::FreeVecForeachRet::OK;
+        });
+}
+
+TEST(DenseFreeVec, BenchSpawnDestroyIterate)
+{
+    std::mt19937 gen(42);
+    long sparseSpawnU = 0, denseSpawnU = 0;
+    long sparseIterU = 0, denseIterU = 0;
+    long sparseDestroyU = 0, denseDestroyU = 0;
+    float sinkSparse = 0.0f, sinkDense = 0.0f;
+
+    for (int iter = 0; iter < kIterations; ++iter)
+    {
+        con::FreeVec<BenchObj> sparse;
+        con::DenseFreeVec<BenchObj> dense;
+        std::vector<con::FreeVec<BenchObj>::Handle> sparseHandles;
+        std::vector<con::DenseFreeVec<BenchObj>::Handle> denseHandles;
+        sparseHandles.reserve(kNumObjects);
+        denseHandles.reserve(kNumObjects);
+
+        sparseSpawnU += measureU(
+            [&]()
+            {
+                for (int i = 0; i < kNumObjects; ++i)
+                {
+                    sparseHandles.push_back(sparse.addItem(makeObj(i)));
+                }
+            });
+        denseSpawnU += measureU(
+            [&]()
+            {
+                for (int i = 0; i < kNumObjects; ++i)
+                {
+                    denseHandles.push_back(dense.addItem(makeObj(i)));
+                }
+            });
+
+        // Kill 90% in random order, like the pool after a firefight
+        std::vector<int> order(kNumObjects);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+        const int numDestroy = kNumObjects * 9 / 10;
+        sparseDestroyU += measureU(
+            [&]()
+            {
+                for (int i = 0; i < numDestroy; ++i)
+                {
+                    sparse.removeItem(sparseHandles[order[i]]);
+                }
+            });
+        denseDestroyU += measureU(
+            [&]()
+            {
+                for (int i = 0; i < numDestroy; ++i)
+                {
+                    dense.removeItem(denseHandles[order[i]]);
+                }
+            });
+
+        sparseIterU += measureU(
+            [&]()
+            {
+                sparse.foreach (
+                    [&sinkSparse](BenchObj& obj,
+                                  con::FreeVec<BenchObj>::Handle)
+                    {
+                        obj.pos += obj.vel * 0.016f;
+                        sinkSparse += obj.pos.x;
+                        return con::FreeVecForeachRet::OK;
+                    });
+            });
+        denseIterU += measureU(
+            [&]()
+            {
+                dense.forEach(
+                    [&sinkDense](BenchObj& obj,
+                                 con::DenseFreeVec<BenchObj>::Handle)
+                    {
+                        obj.pos += obj.vel * 0.016f;
+                        sinkDense += obj.pos.x;
+                        return con::FreeVecForeachRet::OK;
+                    });
+            });
+        ASSERT_EQ(dense.size(), kNumObjects - numDestroy);
+    }
+    LG_I("FreeVec spawn {} us, destroy {} us, iterate {} us",
+         sparseSpawnU / kIterations,
+         sparseDestroyU / kIterations,
+         sparseIterU / kIterations);
+    LG_I("DenseFreeVec spawn {} us, destroy {} us, iterate {} us",
+         denseSpawnU / kIterations,
+         denseDestroyU / kIterations,
+         denseIterU / kIterations);
+    LG_D("Checksums {} {}", sinkSparse, sinkDense);
+}
@@ -0,0 +1,139 @@
+#include "aabb-tree.hpp"
+#include "bench-util.hpp"
+#include "function-ref.hpp"
+#include "std-inc.hpp"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace
+{
+
+constexpr int kNumProxies = 10000;
+constexpr int kNumQueries = 200000;
+constexpr float kWorldSize = 10000.0f;
+
+// Mirrors the three ways a sector forwards a broadphase query
+struct QueryFrontend
+{
+    con::DynamicAABBTree<uint32_t> tree;
+
+    void queryPointStdFunction(const vec2& point,
+                               std::function<void(const uint32_t&)> callback)
+    {
+        tree.queryPoint(point, callback);
+    }
+    void queryPointFunctionRef(const vec2& point,
+                               con::FunctionRef<void(const uint32_t&)> callback)
+    {
+        tree.queryPoint(point, callback);
+    }
+    template <typename F> void queryPointVisitor(const vec2& point, F&& callback)
+    {
+        tree.queryPoint(point, callback);
+    }
+};
+
+using bench::measureU;
+
+}  // namespace
+
+TEST(FunctionRef, ForwardsArgumentsAndReturn)
+{
+    int calls = 0;
+    auto add = [&calls](int a, int b)
+    {
+        calls++;
+        return a + b;
+    };
+    con::FunctionRef<int(int, int)> ref(add);
+    EXPECT_EQ(ref(2, 3), 5);
+    con::FunctionRef<int(int, int)> copy = ref;
+    EXPECT_EQ(copy(4, 4), 8);
+    EXPECT_EQ(calls, 2);
+
+    std::function<int(int, int)> stdFn = add;
+    con::FunctionRef<int(int, int)> fromStd(stdFn);
+    EXPECT_EQ(fromStd(1, 1), 2);
+    EXPECT_EQ(calls, 3);
+}
+
+TEST(FunctionRef, BenchBroadphasePointQuery)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> posDist(0.0f, kWorldSize);
+    std::uniform_real_distribution<float> sizeDist(5.0f, 50.0f);
+
+    QueryFrontend frontend;
+    for (uint32_t i = 0; i < kNumProxies; ++i)
+    {
+        const vec2 pos(posDist(gen), posDist(gen));
+        const vec2 size(sizeDist(gen), sizeDist(gen));
+        con::AABB box{pos, pos + size};
+        frontend.tree.createProxy(box, i);
+    }
+    std::vector<vec2> points(kNumQueries);
+    for (auto& point : points)
+    {
+        point = vec2(posDist(gen), posDist(gen));
+    }
+
+    // Capture sized like the projectile hit test, exceeds the small buffer
+    // of std::function
+    uint64_t hitsStd = 0, hitsRef = 0, hitsVisitor = 0;
+    const uint32_t except = 42;
+    const float dummy = 1.0f;
+    const long stdU = measureU(
+        [&]()
+        {
+            for (const auto& point : points)
+            {
+                frontend.queryPointStdFunction(
+                    point,
+                    [&hitsStd, &point, &except, &dummy](const uint32_t& id)
+                    {
+                        if (id != except && dummy > 0.0f)
+                            hitsStd += id + (point.x > 0.0f);
+                    });
+            }
+        });
+    const long refU = measureU(
+        [&]()
+        {
+            for (const auto& point : points)
+            {
+                frontend.queryPointFunctionRef(
+                    point,
+                    [&hitsRef, &point, &except, &dummy](const uint32_t& id)
+                    {
+                        if (id != except && dummy > 0.0f)
+                            hitsRef += id + (point.x > 0.0f);
+                    });
+            }
+        });
+    const long visitorU = measureU(
+        [&]()
+        {
+            for (const auto& point : points)
+            {
+                frontend.queryPointVisitor(
+                    point,
+                    [&hitsVisitor, &point, &except, &dummy](const uint32_t& id)
+                    {
+                        if (id != except && dummy > 0.0f)
+                            hitsVisitor += id + (point.x > 0.0f);
+                    });
+            }
+        });
+
+    EXPECT_EQ(hitsStd, hitsRef);
+    EXPECT_EQ(hitsStd, hitsVisitor);
+    LG_I("{} point queries: std::function {} us ({} ns/query), FunctionRef {} "
+         "us ({} ns/query), visitor {} us ({} ns/query)",
+         kNumQueries,
+         stdU,
+         stdU * 1000 / kNumQueries,
+         refU,
+         refU * 1000 / kNumQueries,
+         visitorU,
+         visitorU * 1000 / kNumQueries);
+}
@@ -0,0 +1,18 @@
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+#include "std-inc.hpp"
+
+namespace bench
+{
+
+template <typename Fn> long measureU(Fn&& fn)
+{
+    long start = tim::nowU();
+    fn();
+    return tim::nowU() - start;
+}
+
+}  // namespace bench
+
+#endif